@@ -333,6 +333,7 @@ class YcsbClientTask {
     uint64_t unexpected_aborts_;
     uint64_t snapshot_cache_hits_;
     uint64_t snapshot_cache_misses_;
+    uint64_t snapshot_cache_remote_hits_;
     ThroughputAndAbort bucketed_throughputs_[kMaxOutputBuckets];
     friend std::ostream& operator<<(std::ostream& o, const Outputs& v);
   };
@@ -500,6 +501,7 @@ class YcsbDriver {
     uint64_t unexpected_aborts_;
     uint64_t snapshot_cache_hits_;
     uint64_t snapshot_cache_misses_;
+    uint64_t snapshot_cache_remote_hits_;
     friend std::ostream& operator<<(std::ostream& o, const WorkerResult& v);
   };
   // Total, summary of all workers
@@ -516,7 +518,8 @@ class YcsbDriver {
         total_scans_(0),
         unexpected_aborts_(0),
         snapshot_cache_hits_(0),
-        snapshot_cache_misses_(0) {}
+        snapshot_cache_misses_(0),
+        snapshot_cache_remote_hits_(0) {}
     double   duration_sec_;
     uint32_t worker_count_;
     uint64_t processed_;
@@ -529,6 +532,7 @@ class YcsbDriver {
     uint64_t unexpected_aborts_;
     uint64_t snapshot_cache_hits_;
     uint64_t snapshot_cache_misses_;
+    uint64_t snapshot_cache_remote_hits_;
     WorkerResult workers_[kMaxWorkers];
     std::vector<std::string> papi_results_;
     friend std::ostream& operator<<(std::ostream& o, const Result& v);
@@ -352,10 +352,12 @@ ErrorStack YcsbClientTask::run(thread::Thread* context) {
     if (UNLIKELY(outputs_->processed_ % (1U << 8) == 0)) {  // it's just stats. not too frequent
       outputs_->snapshot_cache_hits_ = context->get_snapshot_cache_hits();
       outputs_->snapshot_cache_misses_ = context->get_snapshot_cache_misses();
+      outputs_->snapshot_cache_remote_hits_ = context->get_snapshot_cache_remote_hits();
     }
   }
   outputs_->snapshot_cache_hits_ = context->get_snapshot_cache_hits();
   outputs_->snapshot_cache_misses_ = context->get_snapshot_cache_misses();
+  outputs_->snapshot_cache_remote_hits_ = context->get_snapshot_cache_remote_hits();
   return kRetOk;
 }
 
@@ -691,6 +691,7 @@ ErrorStack YcsbDriver::run() {
       result.total_scans_ += output->total_scans_;
       result.snapshot_cache_hits_ += output->snapshot_cache_hits_;
       result.snapshot_cache_misses_ += output->snapshot_cache_misses_;
+      result.snapshot_cache_remote_hits_ += output->snapshot_cache_remote_hits_;
     }
     LOG(INFO) << "Intermediate report after " << result.duration_sec_ << " sec";
     LOG(INFO) << result;
@@ -729,6 +730,7 @@ ErrorStack YcsbDriver::run() {
     result.workers_[i].total_scans_ = output->total_scans_;
     result.workers_[i].snapshot_cache_hits_ = output->snapshot_cache_hits_;
     result.workers_[i].snapshot_cache_misses_ = output->snapshot_cache_misses_;
+    result.workers_[i].snapshot_cache_remote_hits_ = output->snapshot_cache_remote_hits_;
     result.processed_ += output->processed_;
     result.race_aborts_ += output->race_aborts_;
     result.lock_aborts_ += output->lock_aborts_;
@@ -739,6 +741,7 @@ ErrorStack YcsbDriver::run() {
     result.total_scans_ += output->total_scans_;
     result.snapshot_cache_hits_ += output->snapshot_cache_hits_;
     result.snapshot_cache_misses_ += output->snapshot_cache_misses_;
+    result.snapshot_cache_remote_hits_ += output->snapshot_cache_remote_hits_;
     if (FLAGS_shifting_workload) {
       for (uint32_t j = 0; j < max_bucket; ++j) {
         sum_buckets->bucketed_throughputs_[j] += output->bucketed_throughputs_[j];
@@ -912,6 +915,8 @@ std::ostream& operator<<(std::ostream& o, const YcsbDriver::Result& v) {
     << "<unexpected_aborts_>" << v.unexpected_aborts_ << "</unexpected_aborts_>"
     << "<snapshot_cache_hits_>" << v.snapshot_cache_hits_ << "</snapshot_cache_hits_>"
     << "<snapshot_cache_misses_>" << v.snapshot_cache_misses_ << "</snapshot_cache_misses_>"
+    << "<snapshot_cache_remote_hits_>" << v.snapshot_cache_remote_hits_
+      << "</snapshot_cache_remote_hits_>"
     << "</total_result>";
   return o;
 }
@@ -933,6 +938,7 @@ std::ostream& operator<<(std::ostream& o, const YcsbDriver::WorkerResult& v) {
     << "<unexab>" << v.unexpected_aborts_ << "</unexab>"
     << "<sphit>" << v.snapshot_cache_hits_ << "</sphit>"
     << "<spmis>" << v.snapshot_cache_misses_ << "</spmis>"
+    << "<sprhit>" << v.snapshot_cache_remote_hits_ << "</sprhit>"
     << "</worker>";
   return o;
 }
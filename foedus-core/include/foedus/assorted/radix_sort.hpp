@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#ifndef FOEDUS_ASSORTED_RADIX_SORT_HPP_
+#define FOEDUS_ASSORTED_RADIX_SORT_HPP_
+
+#include <stdint.h>
+
+namespace foedus {
+namespace assorted {
+
+/**
+ * @brief LSD radix sort of fixed-size entries on the given bytes.
+ * @ingroup ASSORTED
+ * @details
+ * Sorts \e count entries of \e entry_size bytes in \e data, comparing them as if they were
+ * unsigned integers made of the bytes listed in \e byte_order, from the \b least significant to
+ * the most significant. The sort is stable. Ties in the listed bytes keep the input order.
+ *
+ * One pass over the input first finds bytes that have the same value in all entries, which are
+ * skipped. Sort keys in snapshot usually have many such bytes (high bytes of keys and epochs).
+ * Large inputs are then scattered by their most significant varying byte, and each resulting
+ * bucket is sorted while it is still in cache, finally with LSD passes once a bucket fits in L2.
+ * This is much cheaper than std::sort on large inputs.
+ *
+ * If threads > 1 and the input is large enough, the first scatter is split into that many
+ * contiguous chunks processed by separate threads, then the threads take the resulting buckets
+ * one by one. The result is identical to the serial one.
+ *
+ * @param[in,out] data entries to sort
+ * @param[in] buffer scratch area of at least count * entry_size bytes
+ * @param[in] count number of entries. Must be less than 2^32.
+ * @param[in] entry_size size of each entry. Must be 8, 16, or 24.
+ * @param[in] byte_order offsets of the bytes to compare in an entry, least significant first
+ * @param[in] byte_count number of bytes in byte_order
+ * @param[in] threads number of threads to use
+ * @note This assumes a little-endian machine when callers compute byte_order from integers.
+ */
+void radix_sort(
+  void* data,
+  void* buffer,
+  uint64_t count,
+  uint16_t entry_size,
+  const uint8_t* byte_order,
+  uint16_t byte_count,
+  uint16_t threads = 1);
+
+/**
+ * @brief Shorthand of radix_sort() to sort 128-bit unsigned integers.
+ * @ingroup ASSORTED
+ * @param[in,out] data integers to sort
+ * @param[in] buffer scratch area of at least count integers
+ * @param[in] count number of integers
+ * @param[in] ignored_low_bytes the lowest bytes to exclude from comparison. Use it when the low
+ * bits are already in ascending order in the input, such as positions of the entries themselves.
+ * @param[in] threads number of threads to use
+ */
+void radix_sort_uint128(
+  __uint128_t* data,
+  __uint128_t* buffer,
+  uint64_t count,
+  uint16_t ignored_low_bytes = 0,
+  uint16_t threads = 1);
+
+}  // namespace assorted
+}  // namespace foedus
+
+#endif  // FOEDUS_ASSORTED_RADIX_SORT_HPP_
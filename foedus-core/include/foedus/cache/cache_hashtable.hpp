@@ -21,6 +21,8 @@
 #include <stdint.h>
 
 #include <iosfwd>
+#include <vector>
+
 
 #include "foedus/assert_nd.hpp"
 #include "foedus/compiler.hpp"
@@ -273,6 +275,16 @@ class CacheHashtable CXX11_FINAL {
     const storage::SnapshotPagePointer* page_ids,
     ContentId* out) const;
 
+  /**
+   * @brief Same as find() except this also returns the refcount of the entry.
+   * @param[in] page_id Page ID to look for
+   * @param[out] refcount The refcount after this lookup. 0 if not found.
+   * @details
+   * The refcount tells how hot the page is in this cache. This is used when a thread in
+   * another node probes this hashtable, so it's not inlined.
+   */
+  ContentId find_and_get_refcount(storage::SnapshotPagePointer page_id, uint16_t* refcount) const;
+
   /**
    * @brief Called when a cached page is not found.
    * @return the only possible error code is kErrorCodeCacheTooManyOverflow, which is super-rare.
@@ -310,6 +322,25 @@ class CacheHashtable CXX11_FINAL {
    */
   void evict(EvictArgs* args);
 
+  /** An entry returned by collect_hot_entries(). */
+  struct HotEntry {
+    ContentId content_;
+    PageIdTag tag_;
+    uint16_t  refcount_;
+  };
+  /**
+   * @brief Collects up to max_count entries that are referenced most frequently.
+   * @param[in] max_count Max number of entries to collect
+   * @param[out] out Cleared, then receives entries ordered from the hottest
+   * @details
+   * This reuses the refcounts the CLOCK algorithm maintains, so it costs nothing on the
+   * transaction path. Entries whose refcount already dropped to zero are skipped as they are
+   * the next candidates of eviction anyway.
+   * Like evict(), this can run in a race. We might miss or duplicate a few entries.
+   * This is used to save the hot pages for warm restart.
+   */
+  void collect_hot_entries(uint32_t max_count, std::vector<HotEntry>* out) const;
+
   BucketId get_logical_buckets() const ALWAYS_INLINE { return hash_func_.logical_buckets_; }
   BucketId get_physical_buckets() const ALWAYS_INLINE { return hash_func_.physical_buckets_; }
 
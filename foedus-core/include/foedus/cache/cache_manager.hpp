@@ -18,6 +18,8 @@
 #ifndef FOEDUS_CACHE_CACHE_MANAGER_HPP_
 #define FOEDUS_CACHE_CACHE_MANAGER_HPP_
 
+#include <stdint.h>
+
 #include <string>
 
 #include "foedus/fwd.hpp"
@@ -61,6 +63,22 @@ class CacheManager : public DefaultInitializable {
    */
   ErrorStack  stop_cleaner();
 
+  /**
+   * @brief Writes the IDs of the hottest pages in this SOC's cache to the hot-page file.
+   * @details
+   * This is automatically called periodically and at shutdown when
+   * CacheOptions::snapshot_cache_hot_page_file_pattern_ is set. Does nothing otherwise.
+   * Only for SOC engines.
+   */
+  ErrorStack  save_hot_pages();
+  /**
+   * Whether the warm-up from the hot-page file has finished. Also true when there was nothing
+   * to warm up. Only for SOC engines.
+   */
+  bool        is_warmup_done() const;
+  /** Number of pages the warm-up installed to the cache. Only for SOC engines. */
+  uint64_t    get_warmup_pages() const;
+
  private:
   CacheManagerPimpl* pimpl_;
 };
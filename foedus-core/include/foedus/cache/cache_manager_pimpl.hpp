@@ -21,15 +21,85 @@
 #include <atomic>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include "foedus/assert_nd.hpp"
 #include "foedus/fwd.hpp"
 #include "foedus/initializable.hpp"
+#include "foedus/assorted/atomic_fences.hpp"
+#include "foedus/assorted/raw_atomics.hpp"
 #include "foedus/cache/fwd.hpp"
+#include "foedus/fs/fwd.hpp"
 #include "foedus/memory/aligned_memory.hpp"
 #include "foedus/memory/page_pool.hpp"
+#include "foedus/storage/fwd.hpp"
+#include "foedus/storage/storage_id.hpp"
 
 namespace foedus {
 namespace cache {
+/**
+ * @brief Shared data of CacheManagerPimpl, which publishes the snapshot cache of this node
+ * to other nodes.
+ * @ingroup CACHE
+ * @details
+ * When CacheOptions::snapshot_cache_remote_lookup_ is on, a thread in another node probes the
+ * hashtable of this node on its cache miss, and copies or references the page found here.
+ * The hashtable and the pool are private memory of the SOC, so the addresses below are valid
+ * only in the process identified by owner_process_id_.
+ *
+ * @par Lifetime
+ * A remote thread pins this object while it probes the hashtable and copies the page.
+ * On shutdown, the owner closes this object and waits until all pins are released.
+ * Pages referenced (not copied) by remote threads are protected with the same epoch-based
+ * grace period as local pages, so the owner also waits for a grace period if there were any.
+ */
+struct CacheManagerControlBlock {
+  // this is backed by shared memory. not instantiation. just reinterpret_cast.
+  CacheManagerControlBlock() = delete;
+  ~CacheManagerControlBlock() = delete;
+
+  enum Constants {
+    /** When this bit is on in pin_word_, remote threads can pin this object. */
+    kOpenBit = 1U << 31,
+  };
+
+  /**
+   * Pins this object so that the hashtable and the pool are not released during the access.
+   * @return whether successfully pinned. False if the node is not open for remote lookup.
+   */
+  bool try_pin() {
+    uint32_t cur = assorted::atomic_load_acquire<uint32_t>(&pin_word_);
+    while (true) {
+      if ((cur & kOpenBit) == 0) {
+        return false;
+      } else if (assorted::raw_atomic_compare_exchange_weak<uint32_t>(&pin_word_, &cur, cur + 1)) {
+        return true;
+      }
+    }
+  }
+  void unpin() {
+    ASSERT_ND((pin_word_ & ~static_cast<uint32_t>(kOpenBit)) > 0);
+    assorted::raw_atomic_fetch_add<uint32_t>(&pin_word_, -1U);
+  }
+  /** Whether the given process can use the addresses in this object. */
+  bool is_accessible_from(uint64_t process_id) const { return owner_process_id_ == process_id; }
+
+  /** kOpenBit and the number of remote threads pinning this object. */
+  uint32_t          pin_word_;
+  /** Total number of pages in pool_base_. */
+  uint32_t          pool_pages_;
+  /** Process ID of the SOC that owns the memory below. */
+  uint64_t          owner_process_id_;
+  /** The hashtable of the snapshot cache. Valid only in the owner process. */
+  CacheHashtable*   hashtable_;
+  /** The base address of the snapshot page pool. Valid only in the owner process. */
+  storage::Page*    pool_base_;
+  /** Set when a remote thread referenced a page in this node rather than copied it. */
+  bool              referenced_;
+  /** Number of remote lookups this node served. Loosely maintained, just for statistics. */
+  uint64_t          stat_remote_hits_served_;
+};
+
 /**
  * @brief Pimpl object of CacheManager.
  * @ingroup CACHE
@@ -40,6 +110,13 @@ namespace cache {
  * @par Eviction Policy
  * So far we use a simple CLOCK algorithm to minimize the overhead, especially synchronization
  * overhead.
+ *
+ * @par Warm Restart
+ * When CacheOptions::snapshot_cache_hot_page_file_pattern_ is set, the cleaner thread
+ * periodically (and this object at shutdown) writes the IDs of the hottest cached pages to a
+ * per-node file. On the next start, warmup_ reads the list, sorts it by file position, and
+ * prefetches the pages with large sequential reads that also cover small gaps between listed
+ * pages. Each SOC has its own warmup_, so nodes prefetch in parallel.
  */
 class CacheManagerPimpl final : public DefaultInitializable {
  public:
@@ -60,8 +137,42 @@ class CacheManagerPimpl final : public DefaultInitializable {
 
   ErrorStack  stop_cleaner();
 
+  /** Publishes the snapshot cache of this node to other nodes. */
+  void        open_remote_lookup();
+  /** Stops accepting remote lookups and waits for the ongoing ones. */
+  void        close_remote_lookup();
+
+  /** Writes the hottest pages in the cache to the hot-page file. Does nothing if disabled. */
+  ErrorStack  save_hot_pages();
+  /** Main routine of warmup_. */
+  void        handle_warmup(std::vector<storage::SnapshotPagePointer> page_ids);
+  /**
+   * Reads the pages in [page_ids, page_ids + count) from one snapshot file with one read
+   * and installs them to the cache. The page IDs must be sorted and in the same file.
+   * @return the number of installed pages. We stop when the pool has no more room.
+   */
+  uint32_t    warmup_run(
+    SnapshotFileSet* files,
+    const storage::SnapshotPagePointer* page_ids,
+    uint32_t count,
+    memory::AlignedMemory* buffer,
+    memory::PagePoolOffsetChunk* free_pages,
+    uint64_t budget);
+
+  /** Writes the hot-page file in our binary format (atomically replacing the old one). */
+  static ErrorStack write_hot_page_file(
+    const fs::Path& path,
+    const std::vector<storage::SnapshotPagePointer>& page_ids);
+  /** Reads the hot-page file written by write_hot_page_file(). */
+  static ErrorStack read_hot_page_file(
+    const fs::Path& path,
+    std::vector<storage::SnapshotPagePointer>* page_ids);
+
   Engine* const     engine_;
 
+  /** Shared memory to publish the snapshot cache of this node. Null in a master engine. */
+  CacheManagerControlBlock* control_block_;
+
   /**
    * @brief The only cleaner thread in this SOC engine.
    * @details
@@ -110,6 +221,17 @@ class CacheManagerPimpl final : public DefaultInitializable {
 
   /** Number of pages buffered so far. */
   uint64_t  reclaimed_pages_count_;
+
+  /**
+   * @brief The thread to prefetch pages listed in the hot-page file.
+   * @details
+   * Launched only when the hot-page file exists. It quits as soon as it is done.
+   */
+  std::thread           warmup_;
+  /** Whether warmup_ finished (or was not needed at all). */
+  std::atomic<bool>     warmup_done_;
+  /** Number of pages warmup_ installed to the cache. */
+  std::atomic<uint64_t> warmup_pages_;
 };
 }  // namespace cache
 }  // namespace foedus
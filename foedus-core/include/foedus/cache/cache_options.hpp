@@ -17,8 +17,13 @@
  */
 #ifndef FOEDUS_CACHE_CACHE_OPTIONS_HPP_
 #define FOEDUS_CACHE_CACHE_OPTIONS_HPP_
+#include <stdint.h>
+
+#include <string>
+
 #include "foedus/cxx11.hpp"
 #include "foedus/externalize/externalizable.hpp"
+#include "foedus/fs/filesystem.hpp"
 namespace foedus {
 namespace cache {
 /**
@@ -31,6 +36,12 @@ struct CacheOptions CXX11_FINAL : public virtual externalize::Externalizable {
   enum Constants {
     /** Default value for snapshot_cache_size_mb_per_node_. */
     kDefaultSnapshotCacheSizeMbPerNode = 1 << 10,
+    /** Default value for snapshot_cache_hot_page_max_count_. */
+    kDefaultHotPageMaxCount = 1 << 16,
+    /** Default value for snapshot_cache_hot_page_save_interval_ms_. */
+    kDefaultHotPageSaveIntervalMs = 60000,
+    /** Default value for snapshot_cache_remote_copy_threshold_. */
+    kDefaultRemoteCopyThreshold = 2,
   };
 
   /**
@@ -95,6 +106,64 @@ struct CacheOptions CXX11_FINAL : public virtual externalize::Externalizable {
    */
   float       snapshot_cache_urgent_threshold_;
 
+  /**
+   * @brief String pattern of the file that lists hot snapshot pages for warm restart.
+   * @details
+   * When this is non-empty, each SOC periodically and at shutdown writes the page IDs of the
+   * most frequently referenced pages in its snapshot cache to this file.
+   * When the engine restarts, a warm-up thread reads the file and prefetches the listed pages
+   * back into the snapshot cache with large sequential reads, so that the first transactions
+   * after restart do not pay a cache miss for every page they touch.
+   * The pattern can contain "$NODE$", which is replaced with the NUMA node.
+   * Default is empty, which disables the feature.
+   * @see convert_snapshot_cache_hot_page_file_pattern()
+   */
+  fs::FixedPath snapshot_cache_hot_page_file_pattern_;
+
+  /**
+   * @brief Max number of pages each NUMA node saves to and prefetches from the hot-page file.
+   * @details
+   * Prefetching is further capped by the eviction threshold so that the warm-up never
+   * makes the cleaner evict the pages it just read.
+   * Default is 64k pages (256MB per node).
+   */
+  uint32_t    snapshot_cache_hot_page_max_count_;
+
+  /**
+   * @brief Interval in milliseconds to save the hot-page file while the engine is running.
+   * @details
+   * The file is always saved at shutdown. Saving it periodically, too, helps after a crash.
+   * 0 means we save it only at shutdown. Default is one minute.
+   */
+  uint32_t    snapshot_cache_hot_page_save_interval_ms_;
+
+  /**
+   * @brief Whether a cache miss probes the snapshot caches of other NUMA nodes before it reads
+   * the snapshot file.
+   * @details
+   * Without this, a page hot on all sockets is read from the file and cached once per node.
+   * The probe is wait-free just like the local lookup. The snapshot cache of each node is a
+   * private memory of the SOC, so this works only among SOCs in the same process
+   * (SocOptions::soc_type_ kChildEmulated). Other SOCs are simply not probed.
+   * Default is false.
+   */
+  bool        snapshot_cache_remote_lookup_;
+
+  /**
+   * @brief Temperature above which a page found in another node's cache is copied to the
+   * local cache rather than referenced in the remote node.
+   * @details
+   * The temperature is the CLOCK refcount of the remote entry, which each remote lookup also
+   * increments. Hence, a page that is rarely used is just referenced without consuming local
+   * memory, and a page that keeps getting requested is eventually replicated to the local
+   * node for NUMA-local accesses. 0 means we always copy.
+   * Default is 2.
+   */
+  uint16_t    snapshot_cache_remote_copy_threshold_;
+
+  /** converts snapshot_cache_hot_page_file_pattern_ into a string for the given node. */
+  std::string convert_snapshot_cache_hot_page_file_pattern(int node) const;
+
   EXTERNALIZABLE(CacheOptions);
 };
 }  // namespace cache
@@ -28,6 +28,7 @@ struct  CacheBucket;
 struct  CacheBucketStatus;
 class   CacheHashtable;
 class   CacheManager;
+struct  CacheManagerControlBlock;
 class   CacheManagerPimpl;
 struct  CacheOptions;
 struct  HashFunc;
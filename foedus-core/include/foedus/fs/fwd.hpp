@@ -28,6 +28,7 @@ struct  DeviceEmulationOptions;
 class   DirectIoFile;
 struct  FileStatus;
 class   Path;
+class   PersistentMemoryFile;
 struct  SpaceInfo;
 }  // namespace fs
 }  // namespace foedus
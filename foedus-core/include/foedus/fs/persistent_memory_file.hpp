@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#ifndef FOEDUS_FS_PERSISTENT_MEMORY_FILE_HPP_
+#define FOEDUS_FS_PERSISTENT_MEMORY_FILE_HPP_
+#include <stdint.h>
+
+#include <iosfwd>
+#include <string>
+
+#include "foedus/cxx11.hpp"
+#include "foedus/error_code.hpp"
+#include "foedus/fs/path.hpp"
+
+namespace foedus {
+namespace fs {
+
+/**
+ * @brief Represents an append-only file on byte-addressable persistent memory.
+ * @ingroup FILESYSTEM
+ * @details
+ * Unlike DirectIoFile, this class maps the file to memory and appends by copying into the
+ * mapping and flushing the copied cache lines (clwb/clflushopt/clflush, whichever the build
+ * target supports). persist() then issues a store fence, which is all we need for durability
+ * on a DAX filesystem. No write() or fsync() is involved, so durability latency is in the
+ * order of microseconds rather than milliseconds.
+ *
+ * We first try to map the file with MAP_SYNC, which the kernel accepts only on DAX
+ * filesystems. Otherwise (e.g. tmpfs to emulate persistent memory) we fall back to an
+ * ordinary shared mapping, and is_dax() returns false. In that case the flushes order the
+ * writes but do not make them survive a power loss. Fine for experiments only.
+ *
+ * While the file is opened, its size on the filesystem is the mapped capacity, which grows
+ * in chunks of kCapacityChunk. close() shrinks it back to get_current_offset().
+ * Hence, a crashed process leaves a zero-filled tail that the caller must truncate on restart.
+ */
+class PersistentMemoryFile CXX11_FINAL {
+ public:
+  /** Constant values. */
+  enum Constants {
+    /** POSIX open() semantics says -1 is invalid or not-yet-opened. */
+    kInvalidDescriptor = -1,
+    /** The mapped capacity grows in this unit. */
+    kCapacityChunk = 1 << 26,
+    /** Size of the cache lines we flush. */
+    kFlushLineSize = 64,
+  };
+
+  /** Constructs this object without opening it yet. */
+  explicit PersistentMemoryFile(const Path &path);
+
+  /** Automatically closes the file if it is opened. */
+  ~PersistentMemoryFile();
+
+  // Disable default constructors
+  PersistentMemoryFile() CXX11_FUNC_DELETE;
+  PersistentMemoryFile(const PersistentMemoryFile &) CXX11_FUNC_DELETE;
+  PersistentMemoryFile& operator=(const PersistentMemoryFile &) CXX11_FUNC_DELETE;
+
+  /**
+   * @brief Opens (and creates if not exists) the file and maps it for appends.
+   * @details
+   * The initial offset is the current size of the file, same as DirectIoFile with append=true.
+   */
+  ErrorCode       open();
+
+  /** Whether the file is already and successfully opened.*/
+  bool            is_opened() const { return descriptor_ != kInvalidDescriptor; }
+
+  /**
+   * @brief Unmaps and closes the file if not yet closed, trimming it to the current offset.
+   * @return Whether successfully closed.
+   */
+  bool            close();
+
+  /**
+   * @brief Appends the given bytes at the current offset and flushes their cache lines.
+   * @details
+   * The appended bytes are not guaranteed durable until persist() returns.
+   * There is no alignment requirement on either the data or the size.
+   * @pre is_opened()
+   */
+  ErrorCode       append(uint64_t bytes, const void* data);
+
+  /**
+   * @brief Makes all bytes appended so far durable.
+   * @details
+   * On a DAX mapping, this is just a store fence after the flushes in append().
+   * @pre is_opened()
+   */
+  void            persist();
+
+  /**
+   * @brief Discards the content of the file after the given offset.
+   * @details
+   * This method is used only when we restart the engine in order to discard non-durable
+   * parts of log files, same as DirectIoFile::truncate().
+   * @pre is_opened()
+   */
+  ErrorCode       truncate(uint64_t new_length, bool sync = false);
+
+  Path                    get_path() const { return path_; }
+  uint64_t                get_current_offset() const { return current_offset_; }
+  uint64_t                get_capacity() const { return capacity_; }
+  bool                    is_dax() const { return dax_; }
+
+  std::string             to_string() const;
+  friend std::ostream&    operator<<(std::ostream& o, const PersistentMemoryFile& v);
+
+ private:
+  /** Grows the file and its mapping so that it can hold at least the given bytes. */
+  ErrorCode               ensure_capacity(uint64_t bytes);
+  /** Maps [0, capacity_) of the file, trying MAP_SYNC first. */
+  ErrorCode               map_file();
+
+  /** The path of the file being manipulated. */
+  Path                    path_;
+  /** File descriptor of the file. */
+  int                     descriptor_;
+  /** Start address of the mapping. Null when not opened. */
+  char*                   mapped_;
+  /** Size of the mapping, which is also the size of the file while opened. */
+  uint64_t                capacity_;
+  /** Current byte position of this stream. */
+  uint64_t                current_offset_;
+  /** Whether the mapping is DAX (MAP_SYNC). */
+  bool                    dax_;
+};
+}  // namespace fs
+}  // namespace foedus
+#endif  // FOEDUS_FS_PERSISTENT_MEMORY_FILE_HPP_
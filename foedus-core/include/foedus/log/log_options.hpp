@@ -43,6 +43,8 @@ struct LogOptions CXX11_FINAL : public virtual externalize::Externalizable {
     kDefaultLogBufferKb = (1 << 16),
     /** Default value for log_file_size_mb_. */
     kDefaultLogSizeMb = (1 << 14),
+    /** Default value for coalesce_buffer_kb_. */
+    kDefaultCoalesceBufferKb = (1 << 10),
   };
   /**
    * Constructs option values with default values.
@@ -100,6 +102,36 @@ struct LogOptions CXX11_FINAL : public virtual externalize::Externalizable {
    */
   bool                        flush_at_shutdown_;
 
+  /**
+   * @brief Whether each logger gathers all logs of an epoch into one staging buffer.
+   * @details
+   * If false, the logger writes out each thread's piece separately and pads its head and tail
+   * to 4kb with filler logs, which issues many small writes and wastes up to 8kb per thread
+   * per epoch. If true, the logger copies the epoch marker and all threads' pieces back-to-back
+   * into a staging buffer of coalesce_buffer_kb_ and writes it out in large sequential chunks,
+   * padding only once at the end of the epoch.
+   * Both formats are read by the same log mapper. Default is true.
+   */
+  bool                        coalesce_epoch_writes_;
+
+  /**
+   * Size in KB of the staging buffer each logger uses when coalesce_epoch_writes_ is true.
+   * Must be a multiple of 4. Default is 1MB.
+   */
+  uint32_t                    coalesce_buffer_kb_;
+
+  /**
+   * @brief Whether loggers write to byte-addressable persistent memory instead of block devices.
+   * @details
+   * If true, each logger maps its log file to memory (fs::PersistentMemoryFile), appends logs
+   * with memcpy and cache-line flushes, and makes an epoch durable with just a store fence
+   * instead of write() and fsync(). This always coalesces epoch writes without a staging
+   * buffer. The log folders should be on a DAX filesystem; on others (e.g. tmpfs) this only
+   * emulates persistent memory and the logs do not survive a power loss.
+   * Default is false.
+   */
+  bool                        persistent_memory_log_;
+
   /** Settings to emulate slower logging device. */
   foedus::fs::DeviceEmulationOptions emulation_;
 
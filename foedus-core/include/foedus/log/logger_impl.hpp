@@ -255,6 +255,29 @@ class Logger final : public DefaultInitializable, public LoggerRef {
     uint64_t from_offset,
     uint64_t upto_offset);
 
+  /**
+   * Alternative to write_one_epoch() used when LogOptions::coalesce_epoch_writes_ is true.
+   * Copies the epoch marker and all threads' pieces back-to-back into staging_buffer_ and
+   * writes them out in large aligned chunks. Only the end of the epoch is padded.
+   * Same pre/post conditions as write_one_epoch().
+   */
+  ErrorStack  write_one_epoch_coalesced(Epoch write_epoch);
+  /**
+   * Sub-routine of write_one_epoch_coalesced().
+   * Appends the given bytes to staging_buffer_, writing out the buffer whenever it becomes full.
+   * When persistent_memory_, appends directly to the mapped log file instead.
+   */
+  ErrorCode   append_to_staging(const char* data, uint64_t bytes);
+
+  /** Opens current_file_path_ as a DirectIoFile or a PersistentMemoryFile per the options. */
+  ErrorStack  open_current_file();
+  /** Closes and deletes the current file if any. */
+  void        close_current_file();
+  /** Current byte position of the current file, or 0 if no file is opened. */
+  uint64_t    get_current_file_offset() const;
+  /** Appends the given bytes to the current file. They must be 4kb-aligned for DirectIoFile. */
+  ErrorCode   write_to_current_file(uint64_t bytes, const void* data);
+
   /** Check invariants. This method is wiped out in NDEBUG. */
   void        assert_consistent();
   /** Sanity check on logs to write out. This method is wiped out in NDEBUG. */
@@ -280,10 +303,30 @@ class Logger final : public DefaultInitializable, public LoggerRef {
    */
   memory::AlignedMemory           fill_buffer_;
 
+  /**
+   * @brief Staging buffer to coalesce all logs of an epoch.
+   * @details
+   * Allocated only when LogOptions::coalesce_epoch_writes_ is true.
+   * Its content always starts at a 4kb-aligned file offset, and staging_used_ bytes are
+   * pending. The buffer is written out whenever it becomes full, so its size (a multiple of
+   * 4kb) is the granularity of writes the device sees.
+   */
+  memory::AlignedMemory           staging_buffer_;
+  /** Bytes pending in staging_buffer_. Always 0 when persistent_memory_. */
+  uint64_t                        staging_used_;
+
   /**
    * @brief The log file this logger is currently appending to.
    */
   fs::DirectIoFile*               current_file_;
+  /**
+   * @brief The log file this logger is currently appending to when persistent_memory_.
+   * @details
+   * Exactly one of current_file_ and this is non-null while the logger is running.
+   */
+  fs::PersistentMemoryFile*       current_pmem_file_;
+  /** Copy of LogOptions::persistent_memory_log_. */
+  bool                            persistent_memory_;
   /**
    * [log_folder_]/[id_]_[current_ordinal_].log.
    */
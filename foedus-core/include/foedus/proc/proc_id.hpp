@@ -118,6 +118,28 @@ typedef ErrorStack (*Proc)(const ProcArguments& args);
  */
 typedef std::pair<ProcName, Proc> ProcAndName;
 
+/**
+ * @brief The function a shared library of procedures exports to declare its procedures.
+ * @ingroup PROC
+ * @details
+ * A shared library loaded via ProcOptions or ProcManager::load_shared_library() must export
+ * a function of this signature with C linkage, named kProcLibraryInitFuncName.
+ * It writes up to \e capacity procedures to \e out and returns the number of them.
+ * @code{.cpp}
+ * extern "C" uint32_t foedus_proc_library_init(ProcAndName* out, uint32_t capacity) {
+ *   out[0] = ProcAndName("my_proc", &my_proc);
+ *   return 1;
+ * }
+ * @endcode
+ */
+typedef uint32_t (*ProcLibraryInitFunc)(ProcAndName* out, uint32_t capacity);
+
+/**
+ * Name of the ProcLibraryInitFunc function each shared library of procedures exports.
+ * @ingroup PROC
+ */
+const char* const kProcLibraryInitFuncName = "foedus_proc_library_init";
+
 }  // namespace proc
 }  // namespace foedus
 #endif  // FOEDUS_PROC_PROC_ID_HPP_
@@ -54,6 +54,28 @@ class ProcManager CXX11_FINAL : public virtual Initializable {
    */
   ErrorStack  get_proc(const ProcName& name, Proc* out);
 
+  /**
+   * @brief Returns the function pointer of the specified procedure in this SOC.
+   * @param[in] id ID of the procedure in this SOC, obtained via get_local_proc_id().
+   * @param[out] out Function pointer of the procedure.
+   * @return Error if the given ID is not a registered procedure.
+   * @details
+   * Unlike get_proc(), this doesn't search for the name. Use this when the same procedure
+   * is invoked many times, resolving its ID just once.
+   */
+  ErrorStack  get_proc_by_local_id(LocalProcId id, Proc* out);
+
+  /**
+   * @brief Resolves the name of a procedure to its ID in the given SOC.
+   * @param[in] node SOC ID (NUMA node) the ID is used in. A LocalProcId is valid only in the SOC.
+   * @param[in] name Name of the procedure.
+   * @param[out] out ID of the procedure in the SOC.
+   * @return Error if the given procedure name is not found.
+   * @details
+   * This can be called in both the master engine and SOC engines.
+   */
+  ErrorStack  get_local_proc_id(uint16_t node, const ProcName& name, LocalProcId* out);
+
   /**
    * @brief Pre-register a function pointer as a user procedure so that all SOCs will have it
    * when they are forked.
@@ -96,6 +118,34 @@ class ProcManager CXX11_FINAL : public virtual Initializable {
    */
   ErrorStack  emulated_register(const ProcAndName& proc_and_name);
 
+  /**
+   * @brief Loads a shared library of procedures in the current SOC.
+   * @param[in] path Path of the shared library, which exports ProcLibraryInitFunc.
+   * @pre Engine is initialized.
+   * @pre This engine is an SOC engine (child engine), not the master.
+   * @details
+   * Procedures of a new name are registered like local_register().
+   * Procedures of an existing name are \e replaced, keeping the same LocalProcId, so that a new
+   * version of procedures can be deployed without restarting the engine, hence without losing
+   * the buffer pool and snapshot cache. Invocations that already started keep running the old
+   * version. Previously loaded libraries are kept open until the engine shuts down.
+   *
+   * dlopen() returns the already-loaded image for the same path, so a new version
+   * must be placed at a new path, e.g., "libmyprocs.so.2".
+   *
+   * To deploy on all SOCs, run a procedure that calls this method on each NUMA node.
+   * The shared libraries in ProcOptions are loaded by this method during initialization.
+   */
+  ErrorStack  load_shared_library(const std::string& path);
+
+  /**
+   * @brief Returns how many times shared libraries have been loaded in the given SOC.
+   * @details
+   * This can be called in both the master engine and SOC engines. A client can use this
+   * to check that a new version has been deployed in all SOCs.
+   */
+  uint32_t    get_library_version(uint16_t node) const;
+
   /** For debug uses only. Returns a summary of procedures registered in this engine */
   std::string describe_registered_procs() const;
 
@@ -41,6 +41,7 @@ struct ProcManagerControlBlock {
   void initialize() {
     lock_.initialize();
     count_ = 0;
+    library_version_ = 0;
   }
   void uninitialize() {
     lock_.uninitialize();
@@ -53,6 +54,8 @@ struct ProcManagerControlBlock {
    */
   soc::SharedMutex  lock_;
   LocalProcId       count_;
+  /** Incremented whenever a shared library of procedures is loaded in this SOC. */
+  uint32_t          library_version_;
 };
 
 /**
@@ -70,10 +73,15 @@ class ProcManagerPimpl final : public DefaultInitializable {
     ProcManagerControlBlock* control_block_;
     /** The procedure list maintained in this module is an array of ProcName. */
     ProcAndName*  procs_;
-    /** IDs sorted by name for quick lookup */
+    /** IDs sorted by name for quick lookup. The first count_ entries are valid. */
     LocalProcId*  name_sort_;
   };
 
+  enum Constants {
+    /** Max number of procedures one shared library can declare. */
+    kMaxProcsPerLibrary = 1 << 10,
+  };
+
   ProcManagerPimpl() = delete;
   explicit ProcManagerPimpl(Engine* engine) : engine_(engine) {}
 
@@ -82,14 +90,45 @@ class ProcManagerPimpl final : public DefaultInitializable {
 
   std::string describe_registered_procs() const;
   ErrorStack  get_proc(const ProcName& name, Proc* out);
+  ErrorStack  get_proc_by_local_id(LocalProcId id, Proc* out);
+  ErrorStack  get_local_proc_id(soc::SocId node, const ProcName& name, LocalProcId* out);
   ErrorStack  pre_register(const ProcAndName& proc_and_name);
   ErrorStack  local_register(const ProcAndName& proc_and_name);
   ErrorStack  emulated_register(const ProcAndName& proc_and_name);
+  ErrorStack  load_shared_library(const std::string& path);
+  /** Loads all shared libraries specified in ProcOptions for this SOC. */
+  ErrorStack  load_shared_libraries_in_options();
+  /** dlopen() the library and registers its procedures. load_shared_library() minus checks. */
+  ErrorStack  dlopen_and_register(const std::string& path);
+  uint32_t    get_library_version(soc::SocId node) const;
   SharedData* get_local_data();
   const SharedData* get_local_data() const;
 
+  /**
+   * Binary search on name_sort_. The caller must hold lock_.
+   * @return ID of the procedure, kLocalProcInvalid if not found.
+   */
   static LocalProcId find_by_name(const ProcName& name, SharedData* shared_data);
+  /** Takes lock_ and calls find_by_name(). */
+  static LocalProcId find_by_name_with_lock(const ProcName& name, SharedData* shared_data);
+  /**
+   * Appends the procedure and inserts its ID to name_sort_.
+   * @return ID of the new procedure, kLocalProcInvalid if the name already exists.
+   */
   static LocalProcId insert(const ProcAndName& proc_and_name, SharedData* shared_data);
+  /**
+   * Same as insert() except that it replaces the function pointer if the name already exists.
+   * @param[out] replaced whether the name already existed.
+   */
+  static LocalProcId upsert(
+    const ProcAndName& proc_and_name,
+    SharedData* shared_data,
+    bool* replaced);
+  /** Subroutine of insert()/upsert() to add a new procedure at pos of name_sort_. */
+  static LocalProcId append_sorted(
+    const ProcAndName& proc_and_name,
+    LocalProcId pos,
+    SharedData* shared_data);
 
   Engine* const               engine_;
   std::vector< ProcAndName >  pre_registered_procs_;
@@ -97,6 +136,8 @@ class ProcManagerPimpl final : public DefaultInitializable {
    * Shared data of all SOCs. Index is SOC ID.
    */
   std::vector< SharedData >   all_soc_procs_;
+  /** dlopen() handles of shared libraries loaded in this process, closed in uninitialize. */
+  std::vector< void* >        library_handles_;
 };
 static_assert(
   sizeof(ProcManagerControlBlock) <= soc::NodeMemoryAnchors::kProcManagerMemorySize,
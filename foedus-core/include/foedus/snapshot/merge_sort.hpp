@@ -302,7 +302,8 @@ class MergeSort CXX11_FINAL : public DefaultInitializable {
     uint16_t inputs_count,
     uint16_t max_original_pages,
     memory::AlignedMemory* const work_memory,
-    uint16_t chunk_batch_size = kDefaultChunkBatch);
+    uint16_t chunk_batch_size = kDefaultChunkBatch,
+    uint16_t sort_threads = 1);
 
   /**
    * @brief Executes merge-sort on several thousands of logs and provides the result as a batch.
@@ -427,6 +428,8 @@ class MergeSort CXX11_FINAL : public DefaultInitializable {
   const uint16_t                chunk_batch_size_;
   /** Working memory to be used in this class. Automatically expanded if needed. */
   memory::AlignedMemory* const  work_memory_;
+  /** Number of threads to radix-sort each batch. */
+  const uint16_t                sort_threads_;
 
   /**
    * count of sort_entries_ and position_entries_.
@@ -441,6 +444,8 @@ class MergeSort CXX11_FINAL : public DefaultInitializable {
   SortEntry*                    sort_entries_;
   /** Index is MergedPosition */
   PositionEntry*                position_entries_;
+  /** Scratch area of the same size as sort_entries_ for radix sort. */
+  SortEntry*                    radix_buffer_;
   /** kMaxLevels + 1 of original pages. some storage type needs fewer pages. */
   storage::Page*                original_pages_;
   /** index is 0 to inputs_count_ - 1 */
@@ -75,6 +75,17 @@ class SnapshotManager CXX11_FINAL : public virtual Initializable {
     bool wait_completion,
     Epoch suggested_snapshot_epoch = INVALID_EPOCH);
 
+  /**
+   * @brief Immediately evict cold volatile pages whose content is already in the latest snapshot
+   * @param[in] wait_completion whether to block until the completion of the eviction
+   * @details
+   * Snapshot manager automatically does this when the volatile page pool runs short of free
+   * pages (SnapshotOptions::evict_page_pool_percent_). This method is to do it right now.
+   * Only storages whose storage::Metadata::SnapshotThresholds::evict_hotness_threshold_ is
+   * non-zero are subject to eviction. Transaction executions are paused while evicting.
+   */
+  void    trigger_eviction_immediate(bool wait_completion);
+
   /** Do not use this unless you know what you are doing. */
   SnapshotManagerPimpl* get_pimpl() { return pimpl_; }
 
@@ -126,8 +126,11 @@ struct SnapshotManagerControlBlock {
     snapshot_taken_.initialize();
     snapshot_wakeup_.initialize();
     snapshot_children_wakeup_.initialize();
+    eviction_done_.initialize();
     gleaner_.initialize();
     requested_snapshot_epoch_.store(Epoch::kEpochInvalid);
+    requested_evictions_.store(0);
+    completed_evictions_.store(0);
   }
   void uninitialize() {
     gleaner_.uninitialize();
@@ -190,6 +193,16 @@ struct SnapshotManagerControlBlock {
    */
   soc::SharedPolling              snapshot_children_wakeup_;
 
+  /**
+   * Number of eviction requests via trigger_eviction_immediate().
+   * snapshot_thread_ evicts cold volatile pages if this is larger than completed_evictions_.
+   */
+  std::atomic<uint64_t>           requested_evictions_;
+  /** Value of requested_evictions_ as of the beginning of the last eviction. */
+  std::atomic<uint64_t>           completed_evictions_;
+  /** Fired whenever snapshot_thread_ completes evicting volatile pages. */
+  soc::SharedPolling              eviction_done_;
+
   /** Gleaner-related variables */
   LogGleanerControlBlock          gleaner_;
 };
@@ -225,6 +238,7 @@ class SnapshotManagerPimpl final : public DefaultInitializable {
   void    trigger_snapshot_immediate(
     bool wait_completion,
     Epoch suggested_snapshot_epoch);
+  void    trigger_eviction_immediate(bool wait_completion);
   /**
    * This is a hidden API called at the beginning of engine shutdown (namely restart manager).
    * Snapshot Manager initializes before Storage because it must \e read previous snapshot,
@@ -313,6 +327,31 @@ class SnapshotManagerPimpl final : public DefaultInitializable {
     void* result_memory,
     uint16_t parallel_id);
 
+  /**
+   * @brief Drops cold volatile pages whose content is already in the latest snapshot.
+   * @details
+   * handle_snapshot() calls this when some node's volatile pool runs short of free pages
+   * (SnapshotOptions::evict_page_pool_percent_) or when someone requested it.
+   * This is the same as drop_volatile_pages() except that it works on the latest snapshot
+   * rather than a new one, and only on cold pages of storages that opted in
+   * (Metadata::SnapshotThresholds::evict_hotness_threshold_).
+   * Like drop_volatile_pages(), this pauses transaction executions while dropping pages.
+   */
+  ErrorStack  evict_volatile_pages();
+  /** subroutine invoked by one thread for one node. Each thread takes a subset of storages. */
+  void        evict_volatile_pages_parallel(
+    const Snapshot& latest_snapshot,
+    const std::vector<storage::StorageId>& storages,
+    uint16_t parallel_id,
+    uint64_t* dropped_count);
+  /** Whether some node's volatile pool has less free pages than evict_page_pool_percent_. */
+  bool        is_volatile_pool_short() const;
+  /**
+   * Fills snapshot_epochs_ for snapshots taken before this engine started by reading
+   * their snapshot metadata files. Each file is read only once.
+   */
+  void        load_snapshot_epochs();
+
   /**
    * each snapshot has a snapshot-metadata file "snapshot_metadata_<SNAPSHOT_ID>.xml"
    * in first node's first partition folder. */
@@ -347,6 +386,20 @@ class SnapshotManagerPimpl final : public DefaultInitializable {
    */
   std::chrono::system_clock::time_point   previous_snapshot_time_;
 
+  /**
+   * When snapshot_thread_ evicted volatile pages last time.
+   * Read and written only by snapshot_thread_.
+   */
+  std::chrono::system_clock::time_point   previous_eviction_time_;
+
+  /**
+   * The valid-until epoch of each snapshot, indexed by SnapshotId.
+   * Epoch::kEpochInvalid if we don't know it yet. See load_snapshot_epochs().
+   * The evictor needs this to tell whether a snapshot pointer installed by an older snapshot
+   * is still up-to-date. Read and written only by snapshot_thread_ in master engine.
+   */
+  std::vector<Epoch::EpochInteger>        snapshot_epochs_;
+
   /** Mappers in this node. Index is logger ordinal. Empty in master engine. */
   std::vector<LogMapper*>     local_mappers_;
   /** Reducer in this node. Null in master engine. */
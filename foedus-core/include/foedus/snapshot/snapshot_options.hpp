@@ -35,6 +35,7 @@ namespace snapshot {
 struct SnapshotOptions CXX11_FINAL : public virtual externalize::Externalizable {
   enum Constants {
     kDefaultSnapshotTriggerPagePoolPercent = 100,
+    kDefaultEvictPagePoolPercent          = 10,
     kDefaultSnapshotIntervalMilliseconds  = 60000,
     kDefaultLogMapperBucketKb             = 1024,
     kDefaultLogMapperIoBufferMb           = 64,
@@ -73,6 +74,16 @@ struct SnapshotOptions CXX11_FINAL : public virtual externalize::Externalizable
    */
   uint16_t                            snapshot_trigger_page_pool_percent_;
 
+  /**
+   * When the volatile page pool of some node runs under this percent (roughly calculated)
+   * of free pages, snapshot manager evicts cold volatile pages whose content is already in
+   * the latest snapshot, at most once a second.
+   * Only storages whose storage::Metadata::SnapshotThresholds::evict_hotness_threshold_
+   * is non-zero are subject to eviction.
+   * Default is 10. 0 disables eviction.
+   */
+  uint16_t                            evict_page_pool_percent_;
+
   /**
    * Interval in milliseconds to take snapshots.
    * Default is one minute.
@@ -126,6 +137,13 @@ struct SnapshotOptions CXX11_FINAL : public virtual externalize::Externalizable
    */
   uint32_t                            log_reducer_read_io_buffer_kb_;
 
+  /**
+   * Number of threads each reducer uses to radix-sort its buffer before dumping it and
+   * to sort each batch of the final merge-sort. Small inputs are always sorted by one thread.
+   * Default is 1 (no additional threads).
+   */
+  uint16_t                            log_reducer_sort_threads_;
+
   /**
    * The size in MB of one snapshot writer, which holds data pages modified in the snapshot
    * and them sequentially dumps them to a file for each storage.
@@ -31,6 +31,7 @@
 #include "foedus/module_type.hpp"
 #include "foedus/assorted/atomic_fences.hpp"
 #include "foedus/assorted/protected_boundary.hpp"
+#include "foedus/cache/fwd.hpp"
 #include "foedus/log/fwd.hpp"
 #include "foedus/memory/fwd.hpp"
 #include "foedus/memory/shared_memory.hpp"
@@ -317,6 +318,7 @@ struct NodeMemoryAnchors {
     kLogReducerMemorySize = 1 << 12,
     kLoggerMemorySize = 1 << 21,
     kProcManagerMemorySize = 1 << 12,
+    kCacheManagerMemorySize = 1 << 12,
     kMaxBoundaries = 1 << 12,
   };
 
@@ -359,6 +361,12 @@ struct NodeMemoryAnchors {
    */
   proc::LocalProcId*  proc_name_sort_memory_;
 
+  /**
+   * CacheManager's status on this node, which publishes the snapshot cache to other nodes.
+   * Always 4kb.
+   */
+  cache::CacheManagerControlBlock*  cache_manager_memory_;
+
   /**
    * Tiny control memory for LogReducer in this node.
    * Always 4kb.
@@ -71,6 +71,10 @@ union LookupRoute {
 inline uint16_t to_records_in_leaf(uint16_t payload_size) {
   return kDataSize / (assorted::align8(payload_size) + kRecordOverhead);
 }
+/** Same as above, but for the given record header type. */
+inline uint16_t to_records_in_leaf(uint16_t payload_size, RecordHeaderType header_type) {
+  return kDataSize / (assorted::align8(payload_size) + to_record_overhead(header_type));
+}
 
 /**
  * @brief Packages logic and required properties to calculate LookupRoute in array storage
@@ -161,24 +161,51 @@ class Composer CXX11_FINAL {
     memory::PagePoolOffsetChunk*  dropped_chunks_;
     /** [OUT] Number of volatile pages that were dropped */
     uint64_t*                     dropped_count_;
+    /**
+     * Whether the volatile page evictor invoked this rather than snapshot manager right after
+     * taking snapshot_. In that case, snapshot_ is the latest snapshot, which might have been
+     * taken long ago. Only volatile pages whose hotness is below the storage's
+     * Metadata::SnapshotThresholds::evict_hotness_threshold_ are dropped, ignoring the
+     * storage-specific policy on which levels to keep.
+     */
+    bool                          evicting_;
+    /**
+     * Used only when evicting_. The valid-until epoch of each snapshot, indexed by SnapshotId.
+     * Epoch::kEpochInvalid if we don't know the snapshot.
+     */
+    const Epoch::EpochInteger*    snapshot_epochs_;
 
     /**
      * Returns (might cache) the given pointer to volatile pool.
      */
     void drop(Engine* engine, VolatilePagePointer pointer) const;
+
+    /**
+     * Used only when evicting_. Whether the snapshot page the pointer points to contains
+     * all modifications of the volatile page(s) whose newest record is of the given epoch.
+     * This is trivially true if the pointer was installed in snapshot_. Otherwise, the
+     * snapshot page might be stale (eg non-matching page boundaries in masstree), so we
+     * compare the epoch with the valid-until epoch of the snapshot that wrote the page.
+     */
+    bool is_covered_by_snapshot(SnapshotPagePointer pointer, Epoch max_record_epoch) const;
   };
   /** Retrun value of drop_volatiles() */
   struct DropResult {
     explicit DropResult(const DropVolatilesArguments& args) {
       max_observed_ = args.snapshot_.valid_until_epoch_;  // min value to make store_max easier.
+      max_record_epoch_ = INVALID_EPOCH;
       dropped_all_ = true;  // "so far". zero-inspected, thus zero-failure.
     }
     inline void combine(const DropResult& other) {
       max_observed_.store_max(other.max_observed_);
+      if (other.max_record_epoch_.is_valid()) {
+        max_record_epoch_.store_max(other.max_record_epoch_);
+      }
       dropped_all_ &= other.dropped_all_;
     }
 
     inline void on_rec_observed(Epoch epoch) {
+      max_record_epoch_.store_max(epoch);
       if (epoch > max_observed_) {
         max_observed_ = epoch;
         dropped_all_ = false;
@@ -198,6 +225,11 @@ class Composer CXX11_FINAL {
      * Use dropped_all_ for that purpose.
      */
     Epoch max_observed_;
+    /**
+     * Same as max_observed_ except it is not adjusted to args.snapshot_.valid_until_epoch_.
+     * Invalid if no record was observed. The evictor needs this to compare with older snapshots.
+     */
+    Epoch max_record_epoch_;
     /** Whether all volatile pages under the page was dropped. */
     bool  dropped_all_;
     bool  padding_[3];
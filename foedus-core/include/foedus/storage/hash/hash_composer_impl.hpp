@@ -121,6 +121,11 @@ class HashComposer final {
    * threshold epoch (valid_until).
    */
   bool can_drop_volatile_bin(VolatilePagePointer head, Epoch valid_until) const;
+  /**
+   * Used only when evicting.
+   * @returns if all data pages in the bin are below the storage's evict_hotness_threshold_.
+   */
+  bool is_cold_bin(VolatilePagePointer head) const;
 
   /** Drops all data pages in a bin, starting from the pointer. */
   void drop_volatile_entire_bin(
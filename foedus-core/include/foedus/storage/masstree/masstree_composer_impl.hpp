@@ -238,13 +238,25 @@ class MasstreeComposeContext {
       KeySlice slice = normalize_be_bytes_full_aligned(key + layer_ * kSliceLen);
       return contains_slice(slice);
     }
+    /**
+     * Whether the next original record is ordered before or at the given key.
+     * The original record of the same key must be consumed, too, so that a following
+     * delete/update/overwrite finds it as the tail record.
+     */
     bool needs_to_consume_original(KeySlice slice, KeyLength key_length) const {
-      return has_next_original()
-        && (
-          next_original_slice_ < slice
-          || (next_original_slice_ == slice
-              && next_original_remainder_ > kSliceLen
-              && key_length > (layer_ + 1U) * kSliceLen));
+      if (!has_next_original() || next_original_slice_ > slice) {
+        return false;
+      } else if (next_original_slice_ < slice) {
+        return true;
+      }
+      const KeyLength remainder = key_length - layer_ * kSliceLen;
+      if (next_original_remainder_ > kSliceLen) {
+        // next layer or a long key. only a longer key shares it.
+        return remainder > kSliceLen;
+      } else {
+        // a short key. shorter (or same) keys come first.
+        return next_original_remainder_ <= remainder;
+      }
     }
 
     friend std::ostream& operator<<(std::ostream& o, const PathLevel& v);
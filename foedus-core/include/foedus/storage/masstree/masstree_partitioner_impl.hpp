@@ -80,6 +80,12 @@ namespace masstree {
  * For each pointer, we determine the owner node simply based on the last updater
  * of the pointed page, which is a rough statistics in the page header (no correctness guaranteed).
  *
+ * @par Following the workload
+ * Once we have a snapshot, the partition keys must stay the same as the previous snapshot's
+ * root page. However, the owner nodes are re-evaluated in each snapshot by sampling current
+ * volatile pages, weighted by their temperature. So, when the workload shifts to other nodes,
+ * the new snapshot pages of the partition are written in the node that now accesses it.
+ *
  * @par Expected issues
  * The scheme above is so simple and easy to implement/maintain.
  * Of course the simplicity has its price. If all keys start with a common 8-bytes, we are screwed.
@@ -118,6 +124,14 @@ class MasstreePartitioner final {
    * be now changing.
    */
   ErrorStack  design_partition_first(const MasstreeIntermediatePage* root);
+  /**
+   * When there is a previous snapshot. Partition keys are already copied from the previous
+   * snapshot's root page, which we must keep. This method re-evaluates only the assigned node
+   * of each partition by sampling current volatile pages. Partitions without volatile pages
+   * keep the previous assignment.
+   * @param[in] root a stable copy of the root volatile page.
+   */
+  ErrorStack  design_partition_adaptive(const MasstreeIntermediatePage* root);
 
   void sort_batch_8bytes(const Partitioner::SortBatchArguments& args) const;
   void sort_batch_general(const Partitioner::SortBatchArguments& args) const;
@@ -175,10 +189,10 @@ struct OwnerSamples {
   /** node_id to be the owner of the subtree */
   uint32_t*       assignments_;
 
-  void increment(uint32_t node, uint32_t subtree_id) {
+  void increment(uint32_t node, uint32_t subtree_id, uint32_t weight = 1U) {
     ASSERT_ND(node < nodes_);
     ASSERT_ND(subtree_id < subtrees_);
-    ++occurrences_[subtree_id * nodes_ + node];
+    occurrences_[subtree_id * nodes_ + node] += weight;
   }
   uint32_t at(uint32_t node, uint32_t subtree_id) const {
     ASSERT_ND(node < nodes_);
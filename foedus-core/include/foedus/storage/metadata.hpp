@@ -58,7 +58,8 @@ namespace storage {
 struct Metadata {
   /** Tuning parameters related to snapshotting. */
   struct SnapshotThresholds {
-    SnapshotThresholds() : snapshot_trigger_threshold_(0), snapshot_keep_threshold_(0) {}
+    SnapshotThresholds()
+      : snapshot_trigger_threshold_(0), snapshot_keep_threshold_(0), evict_hotness_threshold_(0) {}
     /**
      * [Not implemented yet] If this storage has more than this number of volatile pages,
      * log gleaner will soon start to drop some of the volatile pages.
@@ -74,6 +75,15 @@ struct Metadata {
      * Checkout the derived metadata class.
      */
     uint32_t        snapshot_keep_threshold_;
+    /**
+     * When the volatile page pool runs short between snapshots, the snapshot manager evicts
+     * volatile pages of this storage whose hotness (PageHeader::hotness_) is below this value,
+     * as far as their content is already in the latest snapshot.
+     * Unlike the knobs above, this ignores the storage-specific policy on which levels to keep.
+     * Default is 0, meaning volatile pages of this storage are never evicted between snapshots.
+     * @see snapshot::SnapshotOptions::evict_page_pool_percent_
+     */
+    uint32_t        evict_hotness_threshold_;
   };
 
   Metadata()
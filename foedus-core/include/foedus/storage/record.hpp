@@ -57,6 +57,31 @@ const uint16_t kRecordOverhead = sizeof(xct::RwLockableXctId);
 
 CXX11_STATIC_ASSERT(kRecordOverhead == sizeof(Record) - 8, "kRecordOverhead is incorrect");
 
+/**
+ * @brief Layout of the system-managed region in each record.
+ * @ingroup STORAGE
+ * @details
+ * Most records use the 16-byte RwLockableXctId. Narrow records can instead use the 8-byte
+ * xct::CompactLockableXctId to put more records in each page, giving up MCS RW locking.
+ */
+enum RecordHeaderType {
+  /** xct::RwLockableXctId. MCS RW lock plus XctId, 16 bytes. */
+  kRecordHeaderStandard = 0,
+  /** xct::CompactLockableXctId. A lock bit embedded in XctId, 8 bytes. */
+  kRecordHeaderCompact = 1,
+};
+
+/**
+ * @brief Byte size of system-managed region per each record with kRecordHeaderCompact.
+ * @ingroup STORAGE
+ */
+const uint16_t kCompactRecordOverhead = sizeof(xct::CompactLockableXctId);
+
+/** Returns the byte size of system-managed region per each record of the given header type. */
+inline uint16_t to_record_overhead(RecordHeaderType header_type) {
+  return header_type == kRecordHeaderCompact ? kCompactRecordOverhead : kRecordOverhead;
+}
+
 }  // namespace storage
 }  // namespace foedus
 #endif  // FOEDUS_STORAGE_RECORD_HPP_
@@ -27,8 +27,12 @@ namespace foedus {
 namespace thread {
 class   GrabFreeVolatilePagesScope;
 struct  ImpersonateSession;
+struct  PipelinedResult;
+struct  PipelinedSession;
 class   Rendezvous;
 class   StoppableThread;
+struct  TaskQueue;
+struct  TaskQueueEntry;
 class   Thread;
 struct  ThreadControlBlock;
 class   ThreadGroup;
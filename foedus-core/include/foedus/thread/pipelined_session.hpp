@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#ifndef FOEDUS_THREAD_PIPELINED_SESSION_HPP_
+#define FOEDUS_THREAD_PIPELINED_SESSION_HPP_
+#include <stdint.h>
+
+#include <iosfwd>
+
+#include "foedus/cxx11.hpp"
+#include "foedus/error_code.hpp"
+#include "foedus/error_stack.hpp"
+#include "foedus/proc/proc_id.hpp"
+#include "foedus/thread/fwd.hpp"
+#include "foedus/thread/impersonate_session.hpp"
+
+namespace foedus {
+namespace thread {
+
+/**
+ * @brief Result of one task run in a PipelinedSession.
+ * @ingroup THREADPOOL
+ * @details
+ * output_ points to the output slot of the task on shared memory.
+ * It is valid until the next submission to the same session.
+ */
+struct PipelinedResult {
+  ErrorCode   result_;
+  uint32_t    output_len_;
+  const void* output_;
+};
+
+/**
+ * @brief An impersonated session that keeps running many small tasks on one worker thread.
+ * @ingroup THREADPOOL
+ * @details
+ * @par Overview
+ * ImpersonateSession runs exactly one procedure per impersonation. That is fine for
+ * long-running procedures, but for short ones the handshake dominates: the client copies the
+ * input, wakes up the worker, waits for the completion, and releases the thread before it can
+ * submit the next task. Each step costs a round trip on the shared-memory condition variables.
+ *
+ * A pipelined session instead impersonates the worker thread once and then keeps feeding it with
+ * tasks through a single-producer/single-consumer ring in shared memory (TaskQueue).
+ * The client can have up to get_capacity() tasks in flight, submit a batch of them with one
+ * release-store and one wakeup, and reap the results in submission order while the worker keeps
+ * running the following tasks.
+ *
+ * @par Procedure IDs
+ * Tasks refer to procedures by LocalProcId rather than by ProcName so that the worker does not
+ * search for the procedure for each task. Call resolve_proc() once to convert a name.
+ *
+ * @par Limitations
+ * Input and output of each task must fit in kSlotSize bytes of TaskQueue.
+ * Results must be reaped in submission order.
+ *
+ * @par Copy/Move
+ * Not copy-able because the destructor closes the session in shared memory.
+ */
+struct PipelinedSession CXX11_FINAL {
+  PipelinedSession() : submitted_(0), reaped_(0) {}
+  ~PipelinedSession() { release(); }
+
+  // Not copy-able
+  PipelinedSession(const PipelinedSession& other) CXX11_FUNC_DELETE;
+  PipelinedSession& operator=(const PipelinedSession& other) CXX11_FUNC_DELETE;
+
+  /** Returns if the impersonation succeeded. */
+  bool        is_valid() const { return session_.is_valid(); }
+  /** Returns the maximum number of tasks in flight. */
+  static uint32_t get_capacity();
+  /** Returns the maximum byte size of input and output of each task. */
+  static uint32_t get_slot_size();
+
+  /**
+   * @brief Converts a procedure name to the ID the impersonated thread recognizes.
+   * @pre is_valid()==true
+   */
+  ErrorStack  resolve_proc(const proc::ProcName& name, proc::LocalProcId* out) const;
+
+  /**
+   * @brief Submits one task.
+   * @return whether the task is submitted. False if the queue is full or the input is too large.
+   * @pre is_valid()==true
+   */
+  bool        submit(proc::LocalProcId proc_id, const void* input, uint32_t input_len);
+
+  /**
+   * @brief Submits tasks at once, publishing them to the worker with a single wakeup.
+   * @param[in] count number of tasks to submit
+   * @param[in] proc_ids ID of the procedure for each task
+   * @param[in] inputs input data for each task
+   * @param[in] input_lens byte size of input for each task
+   * @return number of tasks submitted, which is smaller than count if the queue becomes full
+   * or a task's input is too large. Tasks are submitted in the order, so the first returned-count
+   * tasks are submitted.
+   * @pre is_valid()==true
+   */
+  uint32_t    submit_batch(
+    uint32_t count,
+    const proc::LocalProcId* proc_ids,
+    const void* const* inputs,
+    const uint32_t* input_lens);
+
+  /** Returns the number of tasks that are submitted but not reaped yet. */
+  uint32_t    get_in_flight() const { return static_cast<uint32_t>(submitted_ - reaped_); }
+  /** Returns the number of completed tasks that can be reaped without waiting. */
+  uint32_t    poll_completions() const;
+
+  /**
+   * @brief Blocks until at least one task can be reaped or the specified time elapses.
+   * @param[in] timeout_microsec timeout in microsec. 0 means an instant check, negative
+   * value means no timeout.
+   * @return True when we observed a completed task.
+   */
+  bool        wait_for_completion(int64_t timeout_microsec = -1) const;
+
+  /**
+   * @brief Retrieves the result of the oldest task that is not reaped yet, blocking until it
+   * completes.
+   * @return False if there is no task in flight.
+   */
+  bool        reap(PipelinedResult* out);
+
+  /**
+   * @brief Waits for all tasks in flight, closes the queue, and releases the thread.
+   * @details
+   * Idempotent like ImpersonateSession::release(). Results not reaped yet are discarded.
+   */
+  void        release();
+
+  friend std::ostream& operator<<(std::ostream& o, const PipelinedSession& v);
+
+  /** The underlying impersonation, which is released when the queue is closed. */
+  ImpersonateSession  session_;
+  /** Number of tasks this client has submitted. */
+  uint64_t            submitted_;
+  /** Number of tasks this client has reaped. */
+  uint64_t            reaped_;
+};
+}  // namespace thread
+}  // namespace foedus
+#endif  // FOEDUS_THREAD_PIPELINED_SESSION_HPP_
@@ -93,9 +93,11 @@ class Thread CXX11_FINAL : public virtual Initializable {
 
   /** [statistics] count of cache hits in snapshot caches */
   uint64_t      get_snapshot_cache_hits() const;
-  /** [statistics] count of cache misses in snapshot caches */
+  /** [statistics] count of cache misses in snapshot caches that read the snapshot file */
   uint64_t      get_snapshot_cache_misses() const;
-  /** [statistics] resets the above two */
+  /** [statistics] count of local cache misses served by the snapshot cache of another node */
+  uint64_t      get_snapshot_cache_remote_hits() const;
+  /** [statistics] resets the above three */
   void          reset_snapshot_cache_counts() const;
 
   /** Shorthand for get_global_volatile_page_resolver.resolve_offset() */
@@ -20,9 +20,11 @@
 
 #include <atomic>
 #include <thread>
+#include <vector>
 
 #include "foedus/fixed_error_stack.hpp"
 #include "foedus/initializable.hpp"
+#include "foedus/assorted/cacheline.hpp"
 #include "foedus/cache/fwd.hpp"
 #include "foedus/cache/snapshot_file_set.hpp"
 #include "foedus/log/thread_log_buffer.hpp"
@@ -44,6 +46,62 @@
 namespace foedus {
 namespace thread {
 
+/**
+ * @brief One task in TaskQueue.
+ * @details
+ * The client sets proc_id_ and input_len_ before publishing the entry.
+ * The worker thread sets output_len_ and result_ before marking it as completed.
+ */
+struct TaskQueueEntry {
+  /** ID of the procedure in the SOC of the worker thread. */
+  proc::LocalProcId proc_id_;
+  /** Byte size of input in the input slot of this entry. */
+  uint32_t          input_len_;
+  /** Byte size of output in the output slot of this entry. */
+  uint32_t          output_len_;
+  /** Error code as the result of the procedure. */
+  ErrorCode         result_;
+};
+
+/**
+ * @brief A lock-free ring of tasks submitted to one impersonated thread.
+ * @details
+ * This is the shared-memory part of PipelinedSession.
+ * There is exactly one producer, the client that owns the pipelined impersonation, and exactly one
+ * consumer, the worker thread. Hence, no atomic RMW is needed. submitted_ is written only by the
+ * client and completed_ only by the worker, both with release-stores. The client never submits more
+ * than kCapacity tasks ahead of the ones it has reaped, so the worker never sees an entry being
+ * overwritten.
+ *
+ * Each entry uses a fixed slot of task input/output memory, so submission is just a memcpy.
+ */
+struct TaskQueue {
+  enum Constants {
+    kCapacity = 128,
+    /** Byte size of input and output slot for each entry. kCapacity of them fill 512kb. */
+    kSlotSize = 1 << 12,
+  };
+
+  void initialize() {
+    submitted_ = 0;
+    completed_ = 0;
+    active_ = false;
+    close_requested_ = false;
+  }
+
+  /** Number of tasks published by the client. Written only by the client. */
+  uint64_t        submitted_;
+  char            padding1_[assorted::kCachelineSize - sizeof(uint64_t)];
+  /** Number of tasks the worker has completed. Written only by the worker. */
+  uint64_t        completed_;
+  char            padding2_[assorted::kCachelineSize - sizeof(uint64_t)];
+  /** Whether the current impersonation runs this queue rather than a single proc. */
+  bool            active_;
+  /** Set by the client to let the worker leave the queue after draining it. */
+  bool            close_requested_;
+  TaskQueueEntry  entries_[kCapacity];
+};
+
 /** Shared data of ThreadPimpl */
 struct ThreadControlBlock {
   // this is backed by shared memory. not instantiation. just reinterpret_cast.
@@ -67,6 +125,8 @@ struct ThreadControlBlock {
     my_thread_id_ = my_thread_id;
     stat_snapshot_cache_hits_ = 0;
     stat_snapshot_cache_misses_ = 0;
+    stat_snapshot_cache_remote_hits_ = 0;
+    task_queue_.initialize();
   }
   void uninitialize() {
     task_mutex_.uninitialize();
@@ -144,6 +204,11 @@ struct ThreadControlBlock {
 
   uint64_t            stat_snapshot_cache_hits_;
   uint64_t            stat_snapshot_cache_misses_;
+  /** Cache misses in the local node served by the snapshot cache of another node. */
+  uint64_t            stat_snapshot_cache_remote_hits_;
+
+  /** Tasks of a pipelined impersonation. Used only while task_queue_.active_. */
+  TaskQueue           task_queue_;
 };
 
 /**
@@ -176,6 +241,19 @@ class ThreadPimpl final : public DefaultInitializable {
    * it and re-sets current_task_ when it's done. It exists when exit_requested_ is set.
    */
   void        handle_tasks();
+  /**
+   * Subroutine of handle_tasks() for a pipelined impersonation.
+   * Keeps running tasks in control_block_->task_queue_ until the client closes it.
+   */
+  void        handle_pipelined_tasks();
+  /** Runs the procedure with the given input/output, and returns its result. */
+  ErrorStack  invoke_proc(
+    proc::Proc proc,
+    const void* input,
+    uint32_t input_len,
+    void* output,
+    uint32_t output_capacity,
+    uint32_t* output_used);
   /** initializes the thread's policy/priority */
   void        set_thread_schedule();
   bool        is_stop_requested() const;
@@ -237,6 +315,23 @@ class ThreadPimpl final : public DefaultInitializable {
   ErrorCode on_snapshot_cache_miss(
     storage::SnapshotPagePointer page_id,
     memory::PagePoolOffset* pool_offset);
+  /**
+   * Subroutine of find_or_read_a_snapshot_page() and find_or_read_snapshot_pages_batch()
+   * when the page is not in the local cache. Tries other nodes' caches, then reads the file.
+   */
+  ErrorCode on_snapshot_cache_miss_resolve(
+    storage::SnapshotPagePointer page_id,
+    storage::Page** out);
+  /**
+   * @brief Probes the snapshot caches of other nodes for the page.
+   * @param[in] page_id Page to look for
+   * @param[out] out The page, either copied to the local cache or in the remote cache.
+   * Null if not found in any node.
+   * @see foedus::cache::CacheOptions::snapshot_cache_remote_lookup_
+   */
+  ErrorCode find_in_remote_snapshot_caches(
+    storage::SnapshotPagePointer page_id,
+    storage::Page** out);
 
   /**
    * @brief Subroutine of install_a_volatile_page() and follow_page_pointer() to atomically place
@@ -349,6 +444,11 @@ class ThreadPimpl final : public DefaultInitializable {
   cache::CacheHashtable*  snapshot_cache_hashtable_;
   /** shorthand for node_memory_->get_snapshot_pool() */
   memory::PagePool*       snapshot_page_pool_;
+  /**
+   * Snapshot caches of other nodes to probe on a cache miss, starting from the next node.
+   * Empty unless CacheOptions::snapshot_cache_remote_lookup_.
+   */
+  std::vector<cache::CacheManagerControlBlock*> remote_snapshot_caches_;
 
   /** Page resolver to convert all page ID to page pointer. */
   memory::GlobalVolatilePageResolver global_volatile_page_resolver_;
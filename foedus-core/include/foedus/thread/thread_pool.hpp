@@ -27,6 +27,7 @@
 #include "foedus/proc/proc_id.hpp"
 #include "foedus/thread/fwd.hpp"
 #include "foedus/thread/impersonate_session.hpp"
+#include "foedus/thread/pipelined_session.hpp"
 
 namespace foedus {
 namespace thread {
@@ -233,6 +234,21 @@ class ThreadPool CXX11_FINAL : public virtual Initializable {
     return session.get_result();
   }
 
+  /**
+   * @brief Impersonates a thread on the NUMA node for a pipelined session.
+   * @details
+   * Unlike impersonate(), the thread keeps running tasks submitted to the session
+   * until the session is released. This is suitable for many short procedures.
+   * @see PipelinedSession
+   */
+  bool impersonate_pipelined_on_numa_node(ThreadGroupId node, PipelinedSession *session);
+
+  /**
+   * Overload to specify a core to run on.
+   * @see impersonate_pipelined_on_numa_node()
+   */
+  bool impersonate_pipelined_on_numa_core(ThreadId core, PipelinedSession *session);
+
   /** Returns the pimpl of this object. Use it only when you know what you are doing. */
   ThreadPoolPimpl*    get_pimpl() const { return pimpl_; }
 
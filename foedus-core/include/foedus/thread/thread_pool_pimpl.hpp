@@ -62,6 +62,8 @@ class ThreadPoolPimpl final : public DefaultInitializable {
     const void* task_input,
     uint64_t task_input_size,
     ImpersonateSession *session);
+  bool impersonate_pipelined_on_numa_node(ThreadGroupId node, PipelinedSession *session);
+  bool impersonate_pipelined_on_numa_core(ThreadId core, PipelinedSession *session);
 
   ThreadGroupRef*     get_group(ThreadGroupId numa_node) { return &groups_[numa_node]; }
   ThreadGroup*        get_local_group() const { return local_group_; }
@@ -55,6 +55,14 @@ class ThreadRef CXX11_FINAL {
     const void* task_input,
     uint64_t task_input_size,
     ImpersonateSession *session);
+  /**
+   * Conditionally try to occupy this thread for a pipelined session.
+   * Same as try_impersonate() except that the thread runs tasks submitted to the session
+   * until it is released.
+   * @param[out] session the session to run on this thread.
+   * @return whether successfully impersonated.
+   */
+  bool          try_impersonate_pipelined(PipelinedSession *session);
 
   Engine*       get_engine() const { return engine_; }
   ThreadId      get_thread_id() const { return id_; }
@@ -75,6 +83,7 @@ class ThreadRef CXX11_FINAL {
 
   uint64_t      get_snapshot_cache_hits() const;
   uint64_t      get_snapshot_cache_misses() const;
+  uint64_t      get_snapshot_cache_remote_hits() const;
   void          reset_snapshot_cache_counts() const;
 
   friend std::ostream& operator<<(std::ostream& o, const ThreadRef& v);
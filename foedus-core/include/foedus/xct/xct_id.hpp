@@ -1154,6 +1154,95 @@ struct RwLockableXctId {
   friend std::ostream& operator<<(std::ostream& o, const RwLockableXctId& v);
 };
 
+/**
+ * @brief The lock bit of CompactLockableXctId.
+ * @ingroup XCT
+ * @details
+ * XctId reserves 32 bits for the in-epoch ordinal, but kMaxXctOrdinal leaves the highest 8 bits
+ * of them always zero. CompactLockableXctId uses the highest of them as the lock bit.
+ */
+const uint64_t kXctIdCompactLockBit = 1ULL << 31;
+CXX11_STATIC_ASSERT(kXctIdCompactLockBit > kMaxXctOrdinal, "lock bit overlaps with ordinal");
+
+/**
+ * @brief A 64-bit variant of RwLockableXctId where the lock and the version share one word.
+ * @ingroup XCT
+ * @details
+ * RwLockableXctId spends 16 bytes per record, which is fine for usual records but
+ * doubles the footprint of narrow records (8-32 byte payloads).
+ * This variant is closer to SILO [TU13]'s TID word; an exclusive lock bit is embedded in the
+ * unused bits of the ordinal part of XctId, so the entire record header fits in 8 bytes.
+ *
+ * @par Locking
+ * The lock is a simple test-and-set lock without MCS queue or reader-lock.
+ * It thus scales worse than McsRwLock under heavy contention, and it can't be used for
+ * pessimistic read-locks (MOCC). Choose this variant only for narrow, not-so-contended records.
+ * Unlocking is usually done along with installing the new XctId, which is a single release-store
+ * of the entire word.
+ *
+ * @par POD
+ * This is a POD struct. Default destructor/copy-constructor/assignment operator work fine.
+ */
+struct CompactLockableXctId {
+  /** XctId bits plus kXctIdCompactLockBit. */
+  uint64_t      data_;
+
+  /** Returns the XctId part without the lock bit. This is a "relaxed" read. */
+  XctId   get_xct_id() const ALWAYS_INLINE { return to_xct_id(data_); }
+  XctId   get_xct_id_acquire() const ALWAYS_INLINE {
+    return to_xct_id(assorted::atomic_load_acquire<uint64_t>(&data_));
+  }
+
+  bool is_keylocked() const ALWAYS_INLINE { return (data_ & kXctIdCompactLockBit) != 0; }
+  bool is_deleted() const ALWAYS_INLINE { return get_xct_id().is_deleted(); }
+  bool is_moved() const ALWAYS_INLINE { return get_xct_id().is_moved(); }
+  bool is_next_layer() const ALWAYS_INLINE { return get_xct_id().is_next_layer(); }
+  bool needs_track_moved() const ALWAYS_INLINE { return get_xct_id().needs_track_moved(); }
+  bool is_being_written() const ALWAYS_INLINE { return get_xct_id_acquire().is_being_written(); }
+
+  /** Tries to take the lock just once. Returns whether we took the lock. */
+  bool try_lock() ALWAYS_INLINE {
+    uint64_t expected = assorted::atomic_load_acquire<uint64_t>(&data_) & ~kXctIdCompactLockBit;
+    return assorted::raw_atomic_compare_exchange_strong<uint64_t>(
+      &data_,
+      &expected,
+      expected | kXctIdCompactLockBit);
+  }
+  /** Unconditionally takes the lock, spinning until we get it. */
+  void lock();
+  /** Releases the lock without changing the XctId part. */
+  void unlock() ALWAYS_INLINE {
+    ASSERT_ND(is_keylocked());
+    assorted::raw_atomic_fetch_and_bitwise_and<uint64_t>(&data_, ~kXctIdCompactLockBit);
+  }
+  /**
+   * Installs the new XctId and releases the lock at once.
+   * @pre is_keylocked() by the caller
+   */
+  void unlock_with(XctId new_xct_id) ALWAYS_INLINE {
+    ASSERT_ND(is_keylocked());
+    ASSERT_ND((new_xct_id.data_ & kXctIdCompactLockBit) == 0);
+    assorted::atomic_store_release<uint64_t>(&data_, new_xct_id.data_);
+  }
+  /**
+   * Returns the XctId to remember in read-set for optimistic verification.
+   * This spins while the record is locked or being written, so use it only where
+   * deadlock is not possible.
+   */
+  XctId   spin_while_locked() const;
+
+  /** used only while page initialization */
+  void    reset() ALWAYS_INLINE { data_ = 0; }
+
+  static XctId to_xct_id(uint64_t word) ALWAYS_INLINE {
+    XctId ret;
+    ret.data_ = word & ~kXctIdCompactLockBit;
+    return ret;
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const CompactLockableXctId& v);
+};
+
 class McsOwnerlessLockScope {
  public:
   McsOwnerlessLockScope();
@@ -1246,6 +1335,7 @@ RwLockableXctId* from_universal_lock_id(
 STATIC_SIZE_CHECK(sizeof(XctId), sizeof(uint64_t))
 STATIC_SIZE_CHECK(sizeof(McsWwLock), 8)
 STATIC_SIZE_CHECK(sizeof(LockableXctId), 16)
+STATIC_SIZE_CHECK(sizeof(CompactLockableXctId), 8)
 
 }  // namespace xct
 }  // namespace foedus
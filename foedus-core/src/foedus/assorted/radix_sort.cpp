@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include "foedus/assorted/radix_sort.hpp"
+
+#include <glog/logging.h>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "foedus/assert_nd.hpp"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "radix_sort_uint128() assumes a little-endian machine"
+#endif
+
+namespace foedus {
+namespace assorted {
+
+/** Number of values in a digit (a byte). */
+const uint32_t kRadix = 256;
+/** Below this count, we don't bother launching threads. */
+const uint64_t kParallelThreshold = 1ULL << 16;
+/** Ranges smaller than this (in bytes) are LSD-sorted as they fit in L2 cache. */
+const uint64_t kInCacheBytes = 1ULL << 18;
+
+/** An opaque fixed-size entry that is cheap to copy. */
+template <uint16_t kSize>
+struct RadixEntry {
+  uint64_t words_[kSize / 8];
+};
+
+template <uint16_t kSize>
+inline uint8_t get_digit(const RadixEntry<kSize>* entry, uint8_t byte_offset) {
+  return reinterpret_cast<const uint8_t*>(entry)[byte_offset];
+}
+
+/** Runs func(t) for t in [0, threads). t=0 runs on the calling thread. */
+template <typename FUNC>
+void run_chunks(uint16_t threads, FUNC func) {
+  if (threads == 1U) {
+    func(0);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (uint16_t t = 1; t < threads; ++t) {
+    workers.emplace_back(func, t);
+  }
+  func(0);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * Converts counts to starting offsets. Returns false if all entries have the same digit,
+ * in which case the pass is a no-op and should be skipped.
+ */
+inline bool counts_to_offsets(uint32_t* counts, uint64_t count) {
+  uint32_t total = 0;
+  for (uint32_t digit = 0; digit < kRadix; ++digit) {
+    if (counts[digit] == count) {
+      return false;
+    }
+    uint32_t digit_count = counts[digit];
+    counts[digit] = total;
+    total += digit_count;
+  }
+  ASSERT_ND(total == count);
+  return true;
+}
+
+template <uint16_t kSize>
+inline void scatter(
+  const RadixEntry<kSize>* from,
+  RadixEntry<kSize>* to,
+  uint64_t begin,
+  uint64_t end,
+  uint8_t byte_offset,
+  uint32_t* offsets) {
+  for (uint64_t i = begin; i < end; ++i) {
+    const uint32_t dest = offsets[get_digit(from + i, byte_offset)]++;
+    to[dest] = from[i];
+  }
+}
+
+/**
+ * Stable sort of [data, data + count) on byte_order[0, levels). The result is in data.
+ * Large ranges are scattered by the most significant byte (MSD), and the resulting buckets
+ * are recursively sorted while they are hot in cache. Small ranges are LSD-sorted.
+ */
+template <uint16_t kSize>
+void sort_range(
+  RadixEntry<kSize>* data,
+  RadixEntry<kSize>* buffer,
+  uint64_t count,
+  const uint8_t* byte_order,
+  uint16_t levels) {
+  if (count <= 1U || levels == 0) {
+    return;
+  }
+  ASSERT_ND(count < (1ULL << 32));
+  if (count * kSize > kInCacheBytes) {
+    while (levels > 0) {
+      const uint8_t byte_offset = byte_order[levels - 1U];
+      --levels;
+      uint32_t offsets[kRadix];
+      std::memset(offsets, 0, sizeof(offsets));
+      for (uint64_t i = 0; i < count; ++i) {
+        ++offsets[get_digit(data + i, byte_offset)];
+      }
+      if (!counts_to_offsets(offsets, count)) {
+        continue;  // all entries have the same value in this byte
+      }
+      uint32_t begins[kRadix + 1U];
+      std::memcpy(begins, offsets, sizeof(offsets));
+      begins[kRadix] = count;
+      scatter<kSize>(data, buffer, 0, count, byte_offset, offsets);
+      for (uint32_t digit = 0; digit < kRadix; ++digit) {
+        const uint64_t bucket_count = begins[digit + 1U] - begins[digit];
+        if (bucket_count == 0) {
+          continue;
+        }
+        sort_range<kSize>(
+          buffer + begins[digit],
+          data + begins[digit],
+          bucket_count,
+          byte_order,
+          levels);
+        std::memcpy(data + begins[digit], buffer + begins[digit], bucket_count * kSize);
+      }
+      return;
+    }
+    return;  // all bytes were constant
+  }
+
+  // LSD. count all bytes in one pass first.
+  uint32_t counts[sizeof(RadixEntry<kSize>)][kRadix];
+  std::memset(counts, 0, sizeof(counts[0]) * levels);
+  for (uint64_t i = 0; i < count; ++i) {
+    for (uint16_t b = 0; b < levels; ++b) {
+      ++counts[b][get_digit(data + i, byte_order[b])];
+    }
+  }
+  RadixEntry<kSize>* from = data;
+  RadixEntry<kSize>* to = buffer;
+  for (uint16_t b = 0; b < levels; ++b) {
+    if (!counts_to_offsets(counts[b], count)) {
+      continue;
+    }
+    scatter<kSize>(from, to, 0, count, byte_order[b], counts[b]);
+    RadixEntry<kSize>* tmp = from;
+    from = to;
+    to = tmp;
+  }
+  if (from != data) {
+    std::memcpy(data, from, count * kSize);
+  }
+}
+
+/** Top level of sort_range(), parallelized. */
+template <uint16_t kSize>
+void sort_range_parallel(
+  RadixEntry<kSize>* data,
+  RadixEntry<kSize>* buffer,
+  uint64_t count,
+  const uint8_t* byte_order,
+  uint16_t levels,
+  uint16_t threads) {
+  ASSERT_ND(threads > 1U);
+  std::vector<uint64_t> chunk_begins(threads + 1U);
+  for (uint16_t t = 0; t <= threads; ++t) {
+    chunk_begins[t] = count * t / threads;
+  }
+  // offsets[t][digit]
+  std::vector<uint32_t> offsets(kRadix * threads);
+  while (levels > 0) {
+    const uint8_t byte_offset = byte_order[levels - 1U];
+    --levels;
+    std::memset(&offsets[0], 0, sizeof(uint32_t) * offsets.size());
+    run_chunks(threads, [&](uint16_t t) {
+      uint32_t* my_counts = &offsets[kRadix * t];
+      for (uint64_t i = chunk_begins[t]; i < chunk_begins[t + 1U]; ++i) {
+        ++my_counts[get_digit(data + i, byte_offset)];
+      }
+    });
+
+    // entries of a smaller digit first. within a digit, entries of an earlier chunk first.
+    uint32_t begins[kRadix + 1U];
+    uint32_t total = 0;
+    bool constant_digit = false;
+    for (uint32_t digit = 0; digit < kRadix && !constant_digit; ++digit) {
+      begins[digit] = total;
+      for (uint16_t t = 0; t < threads; ++t) {
+        uint32_t digit_count = offsets[kRadix * t + digit];
+        offsets[kRadix * t + digit] = total;
+        total += digit_count;
+      }
+      constant_digit = (total - begins[digit] == count);
+    }
+    if (constant_digit) {
+      continue;  // all entries have the same value in this byte
+    }
+    ASSERT_ND(total == count);
+    begins[kRadix] = count;
+
+    run_chunks(threads, [&](uint16_t t) {
+      scatter<kSize>(data, buffer, chunk_begins[t], chunk_begins[t + 1U], byte_offset,
+        &offsets[kRadix * t]);
+    });
+
+    // then each thread takes buckets and sorts them. buckets vary in size, so take them
+    // one by one rather than statically assigning them.
+    std::atomic<uint32_t> next_digit(0);
+    run_chunks(threads, [&](uint16_t /*t*/) {
+      while (true) {
+        const uint32_t digit = next_digit++;
+        if (digit >= kRadix) {
+          break;
+        }
+        const uint64_t bucket_count = begins[digit + 1U] - begins[digit];
+        if (bucket_count == 0) {
+          continue;
+        }
+        sort_range<kSize>(
+          buffer + begins[digit],
+          data + begins[digit],
+          bucket_count,
+          byte_order,
+          levels);
+        std::memcpy(data + begins[digit], buffer + begins[digit], bucket_count * kSize);
+      }
+    });
+    return;
+  }
+}
+
+template <uint16_t kSize>
+void radix_sort_impl(
+  RadixEntry<kSize>* data,
+  RadixEntry<kSize>* buffer,
+  uint64_t count,
+  const uint8_t* byte_order,
+  uint16_t byte_count,
+  uint16_t threads) {
+  ASSERT_ND(threads >= 1U);
+  ASSERT_ND(byte_count <= kSize);
+  // first, find bytes that vary at all in one pass. Sort keys in snapshot usually have many
+  // bytes that are the same in all entries, so this saves a lot of passes.
+  uint64_t diffs[kSize / 8];
+  std::memset(diffs, 0, sizeof(diffs));
+  for (uint64_t i = 1; i < count; ++i) {
+    for (uint16_t w = 0; w < kSize / 8; ++w) {
+      diffs[w] |= data[i].words_[w] ^ data[0].words_[w];
+    }
+  }
+  const uint8_t* diff_bytes = reinterpret_cast<const uint8_t*>(diffs);
+  uint8_t varying_order[kSize];
+  uint16_t levels = 0;
+  for (uint16_t b = 0; b < byte_count; ++b) {
+    if (diff_bytes[byte_order[b]] != 0) {
+      varying_order[levels] = byte_order[b];
+      ++levels;
+    }
+  }
+
+  if (threads > 1U && count * kSize > kInCacheBytes) {
+    sort_range_parallel<kSize>(data, buffer, count, varying_order, levels, threads);
+  } else {
+    sort_range<kSize>(data, buffer, count, varying_order, levels);
+  }
+}
+
+void radix_sort(
+  void* data,
+  void* buffer,
+  uint64_t count,
+  uint16_t entry_size,
+  const uint8_t* byte_order,
+  uint16_t byte_count,
+  uint16_t threads) {
+  if (count <= 1U) {
+    return;
+  }
+  if (threads == 0 || count < kParallelThreshold) {
+    threads = 1;
+  }
+  switch (entry_size) {
+  case 8:
+    radix_sort_impl<8>(
+      reinterpret_cast<RadixEntry<8>*>(data),
+      reinterpret_cast<RadixEntry<8>*>(buffer),
+      count,
+      byte_order,
+      byte_count,
+      threads);
+    break;
+  case 16:
+    radix_sort_impl<16>(
+      reinterpret_cast<RadixEntry<16>*>(data),
+      reinterpret_cast<RadixEntry<16>*>(buffer),
+      count,
+      byte_order,
+      byte_count,
+      threads);
+    break;
+  case 24:
+    radix_sort_impl<24>(
+      reinterpret_cast<RadixEntry<24>*>(data),
+      reinterpret_cast<RadixEntry<24>*>(buffer),
+      count,
+      byte_order,
+      byte_count,
+      threads);
+    break;
+  default:
+    LOG(FATAL) << "radix_sort(): unsupported entry size " << entry_size;
+  }
+}
+
+void radix_sort_uint128(
+  __uint128_t* data,
+  __uint128_t* buffer,
+  uint64_t count,
+  uint16_t ignored_low_bytes,
+  uint16_t threads) {
+  ASSERT_ND(ignored_low_bytes < sizeof(__uint128_t));
+  uint8_t byte_order[sizeof(__uint128_t)];
+  uint16_t byte_count = 0;
+  for (uint8_t b = ignored_low_bytes; b < sizeof(__uint128_t); ++b) {
+    byte_order[byte_count] = b;
+    ++byte_count;
+  }
+  radix_sort(data, buffer, count, sizeof(__uint128_t), byte_order, byte_count, threads);
+}
+
+}  // namespace assorted
+}  // namespace foedus
@@ -20,7 +20,9 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <ostream>
+#include <vector>
 
 #include "foedus/assorted/assorted_func.hpp"
 #include "foedus/cache/snapshot_file_set.hpp"
@@ -348,6 +350,80 @@ ErrorStack CacheHashtable::verify_single_thread() const {
   return kRetOk;
 }
 
+ContentId CacheHashtable::find_and_get_refcount(
+  storage::SnapshotPagePointer page_id,
+  uint16_t* refcount) const {
+  ASSERT_ND(page_id > 0);
+  *refcount = 0;
+  BucketId bucket_number = get_bucket_number(page_id);
+  ASSERT_ND(bucket_number < get_logical_buckets());
+  PageIdTag tag = HashFunc::get_tag(page_id);
+  ASSERT_ND(tag != 0);
+  for (uint16_t i = 0; i < kHopNeighbors; ++i) {
+    const CacheBucket& bucket = buckets_[bucket_number + i];
+    if (bucket.get_tag() == tag) {
+      refcounts_[bucket_number + i].increment();
+      *refcount = refcounts_[bucket_number + i].count_;
+      return bucket.get_content_id();
+    }
+  }
+
+  if (overflow_buckets_head_) {
+    for (OverflowPointer i = overflow_buckets_head_; i != 0;) {
+      if (overflow_buckets_[i].bucket_.get_tag() == tag) {
+        overflow_buckets_[i].refcount_.increment();
+        *refcount = overflow_buckets_[i].refcount_.count_;
+        return overflow_buckets_[i].bucket_.get_content_id();
+      }
+      i = overflow_buckets_[i].next_;
+    }
+  }
+  return 0;
+}
+
+inline bool is_hotter(
+  const CacheHashtable::HotEntry& left,
+  const CacheHashtable::HotEntry& right) {
+  return left.refcount_ > right.refcount_;
+}
+
+void CacheHashtable::collect_hot_entries(uint32_t max_count, std::vector<HotEntry>* out) const {
+  out->clear();
+  if (max_count == 0) {
+    return;
+  }
+
+  BucketId end = get_physical_buckets();
+  for (BucketId i = 0; i < end; ++i) {
+    CacheBucket bucket = buckets_[i];  // 8-byte implicitly-atomic read
+    uint16_t count = refcounts_[i].count_;
+    if (bucket.is_content_set() && count > 0) {
+      HotEntry entry = { bucket.get_content_id(), bucket.get_tag(), count };
+      out->push_back(entry);
+    }
+  }
+
+  if (overflow_buckets_head_) {
+    for (OverflowPointer i = overflow_buckets_head_; i != 0;) {
+      CacheBucket bucket = overflow_buckets_[i].bucket_;
+      uint16_t count = overflow_buckets_[i].refcount_.count_;
+      if (bucket.is_content_set() && count > 0) {
+        HotEntry entry = { bucket.get_content_id(), bucket.get_tag(), count };
+        out->push_back(entry);
+      }
+      i = overflow_buckets_[i].next_;
+    }
+  }
+
+  // we need only the top max_count entries, so partial sort suffices.
+  if (out->size() > max_count) {
+    std::partial_sort(out->begin(), out->begin() + max_count, out->end(), is_hotter);
+    out->resize(max_count);
+  } else {
+    std::sort(out->begin(), out->end(), is_hotter);
+  }
+}
+
 CacheHashtable::Stat CacheHashtable::get_stat_single_thread() const {
   Stat result;
   result.normal_entries_ = 0;
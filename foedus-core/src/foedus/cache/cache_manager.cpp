@@ -36,6 +36,9 @@ ErrorStack CacheManager::initialize_once() { return pimpl_->initialize_once(); }
 ErrorStack CacheManager::uninitialize_once() { return pimpl_->uninitialize_once(); }
 std::string CacheManager::describe() const { return pimpl_->describe(); }
 ErrorStack CacheManager::stop_cleaner() { return pimpl_->stop_cleaner(); }
+ErrorStack CacheManager::save_hot_pages() { return pimpl_->save_hot_pages(); }
+bool CacheManager::is_warmup_done() const { return pimpl_->warmup_done_.load(); }
+uint64_t CacheManager::get_warmup_pages() const { return pimpl_->warmup_pages_.load(); }
 
 }  // namespace cache
 }  // namespace foedus
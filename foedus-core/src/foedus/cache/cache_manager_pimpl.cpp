@@ -17,31 +17,65 @@
  */
 #include "foedus/cache/cache_manager_pimpl.hpp"
 
+#include <unistd.h>
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "foedus/engine.hpp"
 #include "foedus/engine_options.hpp"
+#include "foedus/assorted/assorted_func.hpp"
 #include "foedus/cache/cache_hashtable.hpp"
+#include "foedus/cache/snapshot_file_set.hpp"
 #include "foedus/debugging/stop_watch.hpp"
+#include "foedus/fs/direct_io_file.hpp"
+#include "foedus/fs/filesystem.hpp"
+#include "foedus/fs/path.hpp"
 #include "foedus/memory/engine_memory.hpp"
 #include "foedus/memory/numa_node_memory.hpp"
 #include "foedus/savepoint/savepoint_manager.hpp"
+#include "foedus/soc/shared_memory_repo.hpp"
+#include "foedus/soc/soc_manager.hpp"
+#include "foedus/storage/page.hpp"
 #include "foedus/xct/xct_manager.hpp"
 
 namespace foedus {
 namespace cache {
 
+/** Header of the hot-page file, followed by page_count_ SnapshotPagePointer. */
+struct HotPageFileHeader {
+  uint64_t magic_;
+  uint32_t version_;
+  uint32_t page_count_;
+};
+const uint64_t kHotPageFileMagic = 0x5048535544454F46ULL;  // "FOEDUSHP" in little endian
+const uint32_t kHotPageFileVersion = 1;
+/** Max number of pages warmup_ reads at once. 1MB per read. */
+const uint32_t kWarmupReadPages = 256;
+/**
+ * A listed page farther than this number of pages from the previous listed page starts a new
+ * read. Reading a few unneeded pages is much cheaper than issuing another random read.
+ */
+const uint32_t kWarmupMaxGapPages = 8;
+
 CacheManagerPimpl::CacheManagerPimpl(Engine* engine)
   : engine_(engine),
+  control_block_(nullptr),
   stop_requested_(false),
   pool_(nullptr),
   hashtable_(nullptr),
   reclaimed_pages_(nullptr),
-  reclaimed_pages_count_(0) {
+  reclaimed_pages_count_(0),
+  warmup_done_(true),
+  warmup_pages_(0) {
 }
 
 ErrorStack CacheManagerPimpl::initialize_once() {
@@ -96,6 +130,32 @@ ErrorStack CacheManagerPimpl::initialize_once() {
   stop_requested_.store(false);
   cleaner_ = std::move(std::thread(&CacheManagerPimpl::handle_cleaner, this));
 
+  control_block_ = engine_->get_soc_manager()->get_shared_memory_repo()->get_node_memory_anchors(
+    engine_->get_soc_id())->cache_manager_memory_;
+  if (options.snapshot_cache_remote_lookup_) {
+    open_remote_lookup();
+  }
+
+  // launch the warmup thread if we have the list of hot pages from the previous run
+  warmup_pages_.store(0);
+  warmup_done_.store(true);
+  if (!options.snapshot_cache_hot_page_file_pattern_.empty()) {
+    fs::Path path(options.convert_snapshot_cache_hot_page_file_pattern(engine_->get_soc_id()));
+    if (fs::exists(path)) {
+      std::vector<storage::SnapshotPagePointer> page_ids;
+      ErrorStack read_error = read_hot_page_file(path, &page_ids);
+      if (read_error.is_error()) {
+        // not a big deal. we just start with a cold cache.
+        LOG(WARNING) << "Ignored the hot-page file " << path << ": " << read_error;
+      } else if (!page_ids.empty()) {
+        LOG(INFO) << "Warming up the snapshot cache with " << page_ids.size() << " pages...";
+        warmup_done_.store(false);
+        warmup_ = std::move(
+          std::thread(&CacheManagerPimpl::handle_warmup, this, std::move(page_ids)));
+      }
+    }
+  }
+
   return kRetOk;
 }
 
@@ -107,7 +167,17 @@ ErrorStack CacheManagerPimpl::uninitialize_once() {
 
   LOG(INFO) << "Uninitializing Snapshot Cache... " << describe();
   CHECK_ERROR(stop_cleaner());
+  if (warmup_.joinable()) {
+    warmup_.join();  // it checks stop_requested_, so it quits soon
+  }
+  close_remote_lookup();
+  ErrorStack save_error = save_hot_pages();
+  if (save_error.is_error()) {
+    // the hot-page file is just a hint. never fail the shutdown because of it.
+    LOG(WARNING) << "Failed to save the hot-page file: " << save_error;
+  }
 
+  control_block_ = nullptr;
   pool_ = nullptr;
   hashtable_ = nullptr;
   reclaimed_pages_ = nullptr;
@@ -120,6 +190,9 @@ void CacheManagerPimpl::handle_cleaner() {
   LOG(INFO) << "Here we go. Cleaner thread: " << describe();
 
   const uint32_t kIntervalMs = 5;  // should be a bit shorter than epoch-advance interval
+  const uint32_t save_interval_ms
+    = engine_->get_options().cache_.snapshot_cache_hot_page_save_interval_ms_;
+  auto last_save = std::chrono::steady_clock::now();
   while (!stop_requested_) {
     DVLOG(2) << "Cleaner thread came in: " << describe();
     ASSERT_ND(reclaimed_pages_count_ == 0);
@@ -179,6 +252,17 @@ void CacheManagerPimpl::handle_cleaner() {
       DVLOG(2) << "Still enough free pages. do nothing";
     }
 
+    if (save_interval_ms > 0 && !stop_requested_) {
+      auto now = std::chrono::steady_clock::now();
+      if (now - last_save >= std::chrono::milliseconds(save_interval_ms)) {
+        last_save = now;
+        ErrorStack save_error = save_hot_pages();
+        if (save_error.is_error()) {
+          LOG(WARNING) << "Failed to save the hot-page file: " << save_error;
+        }
+      }
+    }
+
     if (!stop_requested_) {
       std::this_thread::sleep_for(std::chrono::milliseconds(kIntervalMs));
     }
@@ -208,7 +292,284 @@ ErrorStack CacheManagerPimpl::stop_cleaner() {
   }
   return kRetOk;
 }
+void CacheManagerPimpl::open_remote_lookup() {
+  ASSERT_ND(control_block_);
+  control_block_->pin_word_ = 0;
+  control_block_->pool_pages_ = total_pages_;
+  control_block_->owner_process_id_ = ::getpid();
+  control_block_->hashtable_ = hashtable_;
+  control_block_->pool_base_ = pool_->get_base();
+  control_block_->referenced_ = false;
+  control_block_->stat_remote_hits_served_ = 0;
+  assorted::atomic_store_release<uint32_t>(
+    &control_block_->pin_word_,
+    CacheManagerControlBlock::kOpenBit);
+  LOG(INFO) << "Opened the snapshot cache in Node-" << engine_->get_soc_id()
+    << " for remote lookups";
+}
+
+void CacheManagerPimpl::close_remote_lookup() {
+  if (control_block_ == nullptr
+    || (assorted::atomic_load_acquire<uint32_t>(&control_block_->pin_word_)
+      & CacheManagerControlBlock::kOpenBit) == 0) {
+    return;
+  }
+
+  const uint32_t kOpenBit = CacheManagerControlBlock::kOpenBit;
+  assorted::raw_atomic_fetch_and_bitwise_and<uint32_t>(&control_block_->pin_word_, ~kOpenBit);
+  // Each pin is just for a hashtable probe and a 4kb copy, so this wouldn't take long.
+  while (assorted::atomic_load_acquire<uint32_t>(&control_block_->pin_word_) != 0) {
+    std::this_thread::yield();
+  }
+  if (control_block_->referenced_) {
+    // Remote threads might be still reading pages they referenced. Wait for the grace period
+    // as if we evicted all pages.
+    uint32_t interval_ms = engine_->get_options().xct_.epoch_advance_interval_ms_;
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms * 2U));
+  }
+  LOG(INFO) << "Closed the snapshot cache in Node-" << engine_->get_soc_id()
+    << " for remote lookups. Served " << control_block_->stat_remote_hits_served_ << " hits";
+  control_block_->hashtable_ = nullptr;
+  control_block_->pool_base_ = nullptr;
+}
+
+ErrorStack CacheManagerPimpl::save_hot_pages() {
+  const CacheOptions& options = engine_->get_options().cache_;
+  if (options.snapshot_cache_hot_page_file_pattern_.empty() || hashtable_ == nullptr) {
+    return kRetOk;
+  } else if (!warmup_done_) {
+    // the cache is not representative yet. keep the list from the previous run.
+    return kRetOk;
+  }
+
+  std::vector<CacheHashtable::HotEntry> entries;
+  hashtable_->collect_hot_entries(options.snapshot_cache_hot_page_max_count_, &entries);
+  if (entries.empty()) {
+    // same as above. an empty cache tells nothing.
+    return kRetOk;
+  }
+
+  // The hashtable knows only the content and a tag. The page itself tells its ID.
+  // Due to the loose synchronization, the content might be stale, so we verify it with the tag.
+  std::vector<storage::SnapshotPagePointer> page_ids;
+  page_ids.reserve(entries.size());
+  const storage::Page* base = pool_->get_base();
+  for (const CacheHashtable::HotEntry& entry : entries) {
+    if (entry.content_ >= total_pages_) {
+      continue;
+    }
+    const storage::PageHeader& header = base[entry.content_].get_header();
+    storage::SnapshotPagePointer page_id = header.page_id_;
+    if (header.snapshot_ && page_id != 0 && HashFunc::get_tag(page_id) == entry.tag_) {
+      page_ids.push_back(page_id);
+    }
+  }
+
+  fs::Path path(options.convert_snapshot_cache_hot_page_file_pattern(engine_->get_soc_id()));
+  debugging::StopWatch watch;
+  CHECK_ERROR(write_hot_page_file(path, page_ids));
+  watch.stop();
+  VLOG(0) << "Saved " << page_ids.size() << " hot pages to " << path << " in "
+    << watch.elapsed_us() << "us";
+  return kRetOk;
+}
+
+ErrorStack CacheManagerPimpl::write_hot_page_file(
+  const fs::Path& path,
+  const std::vector<storage::SnapshotPagePointer>& page_ids) {
+  fs::Path folder = path.parent_path();
+  if (!fs::exists(folder) && !fs::create_directories(folder, true)) {
+    return ERROR_STACK_MSG(kErrorCodeFsMkdirFailed, folder.c_str());
+  }
+
+  // write to a temporary file, then atomically replace the old one
+  fs::Path tmp_path(path.string() + ".tmp");
+  {
+    std::ofstream file(tmp_path.c_str(), std::ofstream::binary | std::ofstream::trunc);
+    if (!file.is_open()) {
+      return ERROR_STACK_MSG(kErrorCodeFsFailedToOpen, tmp_path.c_str());
+    }
+    HotPageFileHeader header;
+    header.magic_ = kHotPageFileMagic;
+    header.version_ = kHotPageFileVersion;
+    header.page_count_ = page_ids.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!page_ids.empty()) {
+      file.write(
+        reinterpret_cast<const char*>(&page_ids[0]),
+        sizeof(storage::SnapshotPagePointer) * page_ids.size());
+    }
+    file.flush();
+    if (!file) {
+      return ERROR_STACK_MSG(kErrorCodeFsWriteFail, tmp_path.c_str());
+    }
+  }
+  if (!fs::fsync(tmp_path)) {
+    return ERROR_STACK_MSG(kErrorCodeFsSyncFailed, tmp_path.c_str());
+  }
+  if (!fs::durable_atomic_rename(tmp_path, path)) {
+    return ERROR_STACK_MSG(kErrorCodeFsWriteFail, path.c_str());
+  }
+  return kRetOk;
+}
+
+ErrorStack CacheManagerPimpl::read_hot_page_file(
+  const fs::Path& path,
+  std::vector<storage::SnapshotPagePointer>* page_ids) {
+  page_ids->clear();
+  std::ifstream file(path.c_str(), std::ifstream::binary);
+  if (!file.is_open()) {
+    return ERROR_STACK_MSG(kErrorCodeFsFailedToOpen, path.c_str());
+  }
+  HotPageFileHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file
+    || header.magic_ != kHotPageFileMagic
+    || header.version_ != kHotPageFileVersion
+    || fs::file_size(path)
+      != sizeof(header) + sizeof(storage::SnapshotPagePointer) * header.page_count_) {
+    return ERROR_STACK_MSG(kErrorCodeCacheHotPageFileCorrupted, path.c_str());
+  }
+  page_ids->resize(header.page_count_);
+  if (header.page_count_ > 0) {
+    file.read(
+      reinterpret_cast<char*>(&(*page_ids)[0]),
+      sizeof(storage::SnapshotPagePointer) * header.page_count_);
+    if (!file) {
+      page_ids->clear();
+      return ERROR_STACK_MSG(kErrorCodeCacheHotPageFileCorrupted, path.c_str());
+    }
+  }
+  return kRetOk;
+}
+
+void CacheManagerPimpl::handle_warmup(std::vector<storage::SnapshotPagePointer> page_ids) {
+  debugging::StopWatch watch;
+  const CacheOptions& options = engine_->get_options().cache_;
+  if (page_ids.size() > options.snapshot_cache_hot_page_max_count_) {
+    page_ids.resize(options.snapshot_cache_hot_page_max_count_);  // the file is hottest-first
+  }
+  // SnapshotPagePointer is snapshot ID, node, then local page ID from the highest bits.
+  // Sorting them makes pages in the same file adjacent and in the order of file position.
+  std::sort(page_ids.begin(), page_ids.end());
+  page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+
+  // Never go beyond the eviction threshold. Otherwise the cleaner would evict what we read.
+  uint64_t allocated = pool_->get_stat().allocated_pages_;
+  uint64_t budget = allocated < cleaner_threshold_ ? cleaner_threshold_ - allocated : 0;
+
+  SnapshotFileSet files(engine_);
+  COERCE_ERROR(files.initialize());
+  memory::AlignedMemory buffer(
+    kWarmupReadPages * sizeof(storage::Page),
+    1ULL << 12,
+    memory::AlignedMemory::kNumaAllocOnnode,
+    engine_->get_soc_id());
+  std::unique_ptr<memory::PagePoolOffsetChunk> free_pages(new memory::PagePoolOffsetChunk());
+
+  uint64_t installed = 0;
+  uint32_t reads = 0;
+  for (uint32_t i = 0; i < page_ids.size() && installed < budget && !stop_requested_;) {
+    storage::SnapshotPagePointer begin = page_ids[i];
+    uint64_t begin_file = begin >> 40U;  // snapshot ID and node. namely the file
+    storage::SnapshotLocalPageId begin_local
+      = storage::extract_local_page_id_from_snapshot_pointer(begin);
+    uint32_t end = i + 1;
+    for (; end < page_ids.size(); ++end) {
+      storage::SnapshotLocalPageId local
+        = storage::extract_local_page_id_from_snapshot_pointer(page_ids[end]);
+      storage::SnapshotLocalPageId prev_local
+        = storage::extract_local_page_id_from_snapshot_pointer(page_ids[end - 1]);
+      if ((page_ids[end] >> 40U) != begin_file
+        || local - begin_local >= kWarmupReadPages
+        || local - prev_local > kWarmupMaxGapPages) {
+        break;
+      }
+    }
+    installed += warmup_run(
+      &files,
+      &page_ids[i],
+      end - i,
+      &buffer,
+      free_pages.get(),
+      budget - installed);
+    ++reads;
+    i = end;
+  }
+
+  if (!free_pages->empty()) {
+    pool_->release(free_pages->size(), free_pages.get());
+  }
+  COERCE_ERROR(files.uninitialize());
+  watch.stop();
+  warmup_pages_.store(installed);
+  warmup_done_.store(true);
+  LOG(INFO) << "Warmed up the snapshot cache with " << installed << " pages out of "
+    << page_ids.size() << " listed pages. " << reads << " reads in " << watch.elapsed_ms()
+    << "ms: " << describe();
+}
 
+uint32_t CacheManagerPimpl::warmup_run(
+  SnapshotFileSet* files,
+  const storage::SnapshotPagePointer* page_ids,
+  uint32_t count,
+  memory::AlignedMemory* buffer,
+  memory::PagePoolOffsetChunk* free_pages,
+  uint64_t budget) {
+  ASSERT_ND(count > 0);
+  storage::SnapshotLocalPageId begin_local
+    = storage::extract_local_page_id_from_snapshot_pointer(page_ids[0]);
+  uint32_t span = storage::extract_local_page_id_from_snapshot_pointer(page_ids[count - 1])
+    - begin_local + 1U;
+  ASSERT_ND(span <= kWarmupReadPages);
+
+  // We don't use SnapshotFileSet::read_pages() as the run might contain unused pages.
+  fs::DirectIoFile* file;
+  ErrorCode code = files->get_or_open_file(page_ids[0], &file);
+  if (code == kErrorCodeOk) {
+    code = file->seek(begin_local * sizeof(storage::Page), fs::DirectIoFile::kDirectIoSeekSet);
+  }
+  if (code == kErrorCodeOk) {
+    code = file->read_raw(span * sizeof(storage::Page), buffer->get_block());
+  }
+  if (code != kErrorCodeOk) {
+    // for example the snapshot files were removed. just skip them.
+    LOG(WARNING) << "Skipped warming up " << count << " pages from "
+      << assorted::Hex(page_ids[0]) << ": " << get_error_name(code);
+    return 0;
+  }
+
+  const storage::Page* pages = reinterpret_cast<const storage::Page*>(buffer->get_block());
+  storage::Page* base = pool_->get_base();
+  uint32_t installed = 0;
+  for (uint32_t i = 0; i < count && installed < budget; ++i) {
+    storage::SnapshotPagePointer page_id = page_ids[i];
+    const storage::Page& page
+      = pages[storage::extract_local_page_id_from_snapshot_pointer(page_id) - begin_local];
+    if (UNLIKELY(page.get_header().page_id_ != page_id)) {
+      LOG(WARNING) << "Hot-page file has an invalid page ID " << assorted::Hex(page_id);
+      continue;
+    } else if (hashtable_->find(page_id) != 0) {
+      continue;  // a worker thread already read it.
+    }
+
+    if (free_pages->empty()) {
+      uint32_t grab_count = std::min<uint64_t>(count - i, free_pages->capacity());
+      if (pool_->grab(grab_count, free_pages) != kErrorCodeOk || free_pages->empty()) {
+        LOG(INFO) << "The snapshot pool ran out of free pages during warmup";
+        break;
+      }
+    }
+    memory::PagePoolOffset offset = free_pages->pop_back();
+    std::memcpy(reinterpret_cast<char*>(base + offset), &page, sizeof(storage::Page));
+    if (hashtable_->install(page_id, offset) != kErrorCodeOk) {
+      free_pages->push_back(offset);
+      continue;
+    }
+    ++installed;
+  }
+  return installed;
+}
 
 std::string CacheManagerPimpl::describe() const {
   if (pool_ == nullptr) {
@@ -224,6 +585,7 @@ std::string CacheManagerPimpl::describe() const {
     << " threshold=\"" << cleaner_threshold_ << "\""
     << " urgent_threshold=\"" << urgent_threshold_ << "\""
     << " reclaimed_count=\"" << reclaimed_pages_count_ << "\""
+    << " warmup_pages=\"" << warmup_pages_.load() << "\""
     << ">" << reclaimed_pages_memory_ << "</SpCache>";
   return str.str();
 }
@@ -17,6 +17,9 @@
  */
 #include "foedus/cache/cache_options.hpp"
 
+#include <string>
+
+#include "foedus/assorted/assorted_func.hpp"
 #include "foedus/memory/page_pool.hpp"
 
 namespace foedus {
@@ -27,7 +30,17 @@ CacheOptions::CacheOptions() {
   private_snapshot_cache_initial_grab_ = memory::PagePoolOffsetChunk::kMaxSize / 2;
   snapshot_cache_eviction_threshold_ = 0.75;
   snapshot_cache_urgent_threshold_ = 0.9;
+  snapshot_cache_hot_page_file_pattern_ = "";
+  snapshot_cache_hot_page_max_count_ = kDefaultHotPageMaxCount;
+  snapshot_cache_hot_page_save_interval_ms_ = kDefaultHotPageSaveIntervalMs;
+  snapshot_cache_remote_lookup_ = false;
+  snapshot_cache_remote_copy_threshold_ = kDefaultRemoteCopyThreshold;
+}
+
+std::string CacheOptions::convert_snapshot_cache_hot_page_file_pattern(int node) const {
+  return assorted::replace_all(snapshot_cache_hot_page_file_pattern_.str(), "$NODE$", node);
 }
+
 ErrorStack CacheOptions::load(tinyxml2::XMLElement* element) {
   EXTERNALIZE_LOAD_ELEMENT(element, snapshot_cache_enabled_);
   EXTERNALIZE_LOAD_ELEMENT(element, snapshot_cache_size_mb_per_node_);
@@ -38,6 +51,11 @@ ErrorStack CacheOptions::load(tinyxml2::XMLElement* element) {
   EXTERNALIZE_LOAD_ELEMENT(element, snapshot_cache_urgent_threshold_);
   ASSERT_ND(snapshot_cache_urgent_threshold_ >= snapshot_cache_eviction_threshold_);
   ASSERT_ND(snapshot_cache_urgent_threshold_ <= 1);
+  EXTERNALIZE_LOAD_ELEMENT(element, snapshot_cache_hot_page_file_pattern_);
+  EXTERNALIZE_LOAD_ELEMENT(element, snapshot_cache_hot_page_max_count_);
+  EXTERNALIZE_LOAD_ELEMENT(element, snapshot_cache_hot_page_save_interval_ms_);
+  EXTERNALIZE_LOAD_ELEMENT(element, snapshot_cache_remote_lookup_);
+  EXTERNALIZE_LOAD_ELEMENT(element, snapshot_cache_remote_copy_threshold_);
   return kRetOk;
 }
 ErrorStack CacheOptions::save(tinyxml2::XMLElement* element) const {
@@ -62,6 +80,20 @@ ErrorStack CacheOptions::save(tinyxml2::XMLElement* element) const {
     snapshot_cache_urgent_threshold_,
     "When the cache eviction performs in an urgent mode, which immediately advances"
     " the current epoch to release pages");
+  EXTERNALIZE_SAVE_ELEMENT(element, snapshot_cache_hot_page_file_pattern_,
+    "String pattern of the file that lists hot snapshot pages for warm restart."
+    " $NODE$ is replaced with the NUMA node. Empty disables the feature.");
+  EXTERNALIZE_SAVE_ELEMENT(element, snapshot_cache_hot_page_max_count_,
+    "Max number of pages each NUMA node saves to and prefetches from the hot-page file.");
+  EXTERNALIZE_SAVE_ELEMENT(element, snapshot_cache_hot_page_save_interval_ms_,
+    "Interval in milliseconds to save the hot-page file while the engine is running."
+    " 0 means we save it only at shutdown.");
+  EXTERNALIZE_SAVE_ELEMENT(element, snapshot_cache_remote_lookup_,
+    "Whether a cache miss probes the snapshot caches of other NUMA nodes before it reads"
+    " the snapshot file. Works only among SOCs in the same process.");
+  EXTERNALIZE_SAVE_ELEMENT(element, snapshot_cache_remote_copy_threshold_,
+    "Temperature (CLOCK refcount in the remote cache) above which a page found in another"
+    " node's cache is copied to the local cache rather than referenced. 0 means always copy.");
   return kRetOk;
 }
 
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include "foedus/fs/persistent_memory_file.hpp"
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif  // defined(__x86_64__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "foedus/assert_nd.hpp"
+#include "foedus/assorted/assorted_func.hpp"
+#include "foedus/fs/filesystem.hpp"
+
+namespace foedus {
+namespace fs {
+
+#if defined(__x86_64__)
+/** Which cache-line write-back instruction this CPU offers. */
+enum FlushInstruction {
+  kFlushClflush = 0,
+  kFlushClflushopt,
+  kFlushClwb,
+};
+
+FlushInstruction detect_flush_instruction() {
+  uint32_t eax, ebx, ecx, edx;
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+    return kFlushClflush;
+  } else if (ebx & (1U << 24)) {
+    return kFlushClwb;
+  } else if (ebx & (1U << 23)) {
+    return kFlushClflushopt;
+  } else {
+    return kFlushClflush;
+  }
+}
+
+const FlushInstruction kFlushInstruction = detect_flush_instruction();
+
+/** Writes back the cache lines of [from, to) to the persistence domain. No fence. */
+void flush_lines(char* from, char* to) {
+  const uintptr_t kMask = ~static_cast<uintptr_t>(PersistentMemoryFile::kFlushLineSize - 1);
+  char* line = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(from) & kMask);
+  for (; line < to; line += PersistentMemoryFile::kFlushLineSize) {
+    switch (kFlushInstruction) {
+    case kFlushClwb:
+      asm volatile("clwb %0" : "+m"(*line));
+      break;
+    case kFlushClflushopt:
+      asm volatile("clflushopt %0" : "+m"(*line));
+      break;
+    default:
+      asm volatile("clflush %0" : "+m"(*line));
+      break;
+    }
+  }
+}
+#endif  // defined(__x86_64__)
+
+PersistentMemoryFile::PersistentMemoryFile(const Path &path)
+  : path_(path),
+  descriptor_(kInvalidDescriptor),
+  mapped_(nullptr),
+  capacity_(0),
+  current_offset_(0),
+  dax_(false) {
+}
+
+PersistentMemoryFile::~PersistentMemoryFile() {
+  close();
+}
+
+ErrorCode PersistentMemoryFile::open() {
+  if (descriptor_ != kInvalidDescriptor) {
+    LOG(ERROR) << "PersistentMemoryFile::open(): already opened. this=" << *this;
+    return kErrorCodeFsAlreadyOpened;
+  }
+  Path folder(path_.parent_path());
+  if (!exists(folder)) {
+    if (!create_directories(folder, true) && !exists(folder)) {
+      LOG(ERROR) << "PersistentMemoryFile::open(): failed to create parent folder: "
+        << folder << ". err=" << assorted::os_error();
+      return kErrorCodeFsMkdirFailed;
+    }
+  }
+
+  mode_t permissions = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH;
+  descriptor_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_LARGEFILE, permissions);
+  if (descriptor_ == kInvalidDescriptor) {
+    LOG(ERROR) << "PersistentMemoryFile::open(): failed to open: " << path_
+      << ". err=" << assorted::os_error();
+    return kErrorCodeFsFailedToOpen;
+  }
+
+  current_offset_ = file_size(path_);
+  capacity_ = 0;
+  ErrorCode ret = ensure_capacity(std::max<uint64_t>(current_offset_, 1U));
+  if (ret != kErrorCodeOk) {
+    ::close(descriptor_);
+    descriptor_ = kInvalidDescriptor;
+    return ret;
+  }
+  LOG(INFO) << "PersistentMemoryFile::open(): successfully opened. " << *this;
+  if (!dax_) {
+    LOG(WARNING) << "PersistentMemoryFile::open(): " << path_ << " is not on a DAX filesystem"
+      << " (MAP_SYNC was rejected). Writes are ordered but not durable against power loss."
+      << " Use this only for testing and performance experiments.";
+  }
+  return kErrorCodeOk;
+}
+
+ErrorCode PersistentMemoryFile::map_file() {
+  ASSERT_ND(mapped_ == nullptr);
+  void* address = MAP_FAILED;
+#if defined(MAP_SYNC) && defined(MAP_SHARED_VALIDATE)
+  address = ::mmap(
+    nullptr,
+    capacity_,
+    PROT_READ | PROT_WRITE,
+    MAP_SHARED_VALIDATE | MAP_SYNC,
+    descriptor_,
+    0);
+#endif  // defined(MAP_SYNC) && defined(MAP_SHARED_VALIDATE)
+  dax_ = (address != MAP_FAILED);
+  if (!dax_) {
+    address = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor_, 0);
+  }
+  if (address == MAP_FAILED) {
+    LOG(ERROR) << "PersistentMemoryFile::map_file(): mmap failed. this=" << *this
+      << " err=" << assorted::os_error();
+    return kErrorCodeFsMmapFailed;
+  }
+  mapped_ = reinterpret_cast<char*>(address);
+  return kErrorCodeOk;
+}
+
+ErrorCode PersistentMemoryFile::ensure_capacity(uint64_t bytes) {
+  if (bytes <= capacity_) {
+    return kErrorCodeOk;
+  }
+  uint64_t new_capacity = assorted::align<uint64_t, kCapacityChunk>(bytes);
+  VLOG(0) << "PersistentMemoryFile::ensure_capacity(): growing " << *this << " to "
+    << new_capacity << " bytes";
+  if (mapped_) {
+    ::munmap(mapped_, capacity_);
+    mapped_ = nullptr;
+  }
+  if (::ftruncate(descriptor_, new_capacity) != 0) {
+    LOG(ERROR) << "PersistentMemoryFile::ensure_capacity(): ftruncate failed. this=" << *this
+      << " err=" << assorted::os_error();
+    return kErrorCodeFsTruncateFailed;
+  }
+  capacity_ = new_capacity;
+  return map_file();
+}
+
+bool PersistentMemoryFile::close() {
+  if (descriptor_ == kInvalidDescriptor) {
+    return false;
+  }
+  bool succeeded = true;
+  if (mapped_) {
+    persist();
+    ::munmap(mapped_, capacity_);
+    mapped_ = nullptr;
+  }
+  if (::ftruncate(descriptor_, current_offset_) != 0 || ::fsync(descriptor_) != 0) {
+    LOG(ERROR) << "PersistentMemoryFile::close(): failed to trim the file. this=" << *this
+      << " err=" << assorted::os_error();
+    succeeded = false;
+  }
+  if (::close(descriptor_) != 0) {
+    LOG(ERROR) << "PersistentMemoryFile::close(): error:" << assorted::os_error()
+      << " file=" << *this << ".";
+    succeeded = false;
+  }
+  LOG(INFO) << "PersistentMemoryFile::close(): closed. " << *this;
+  descriptor_ = kInvalidDescriptor;
+  capacity_ = 0;
+  return succeeded;
+}
+
+ErrorCode PersistentMemoryFile::append(uint64_t bytes, const void* data) {
+  if (!is_opened()) {
+    return kErrorCodeFsNotOpened;
+  } else if (bytes == 0) {
+    return kErrorCodeOk;
+  }
+  CHECK_ERROR_CODE(ensure_capacity(current_offset_ + bytes));
+  char* position = mapped_ + current_offset_;
+  std::memcpy(position, data, bytes);
+#if defined(__x86_64__)
+  flush_lines(position, position + bytes);
+#endif  // defined(__x86_64__)
+  current_offset_ += bytes;
+  return kErrorCodeOk;
+}
+
+void PersistentMemoryFile::persist() {
+  ASSERT_ND(is_opened());
+#if defined(__x86_64__)
+  asm volatile("sfence" ::: "memory");
+#else  // defined(__x86_64__)
+  // no portable cache-line write-back. let the kernel do it for the whole mapping.
+  ::msync(mapped_, capacity_, MS_SYNC);
+#endif  // defined(__x86_64__)
+}
+
+ErrorCode PersistentMemoryFile::truncate(uint64_t new_length, bool sync) {
+  LOG(INFO) << "PersistentMemoryFile::truncate(): truncating " << *this << " to " << new_length
+    << " bytes..";
+  if (!is_opened()) {
+    return kErrorCodeFsNotOpened;
+  }
+  ASSERT_ND(new_length <= current_offset_);
+  // shrink then re-extend to zero-fill the discarded region without unmapping
+  if (::ftruncate(descriptor_, new_length) != 0
+    || ::ftruncate(descriptor_, capacity_) != 0) {
+    LOG(ERROR) << "PersistentMemoryFile::truncate(): failed. this=" << *this
+      << " err=" << assorted::os_error();
+    return kErrorCodeFsTruncateFailed;
+  }
+  current_offset_ = new_length;
+  if (sync) {
+    foedus::fs::fsync(path_, true);
+  }
+  return kErrorCodeOk;
+}
+
+std::string PersistentMemoryFile::to_string() const {
+  std::stringstream s;
+  s << *this;
+  return s.str();
+}
+
+std::ostream& operator<<(std::ostream& o, const PersistentMemoryFile& v) {
+  o << "<PersistentMemoryFile>"
+    << "<path>" << v.path_ << "</path>"
+    << "<descriptor>" << v.descriptor_ << "</descriptor>"
+    << "<capacity>" << v.capacity_ << "</capacity>"
+    << "<current_offset>" << v.current_offset_ << "</current_offset>"
+    << "<dax>" << v.dax_ << "</dax>"
+    << "</PersistentMemoryFile>";
+  return o;
+}
+
+}  // namespace fs
+}  // namespace foedus
@@ -31,6 +31,9 @@ LogOptions::LogOptions() {
   log_buffer_kb_ = kDefaultLogBufferKb;
   log_file_size_mb_ = kDefaultLogSizeMb;
   flush_at_shutdown_ = true;
+  coalesce_epoch_writes_ = true;
+  coalesce_buffer_kb_ = kDefaultCoalesceBufferKb;
+  persistent_memory_log_ = false;
 }
 
 std::string LogOptions::convert_folder_path_pattern(int node, int logger) const {
@@ -58,6 +61,9 @@ ErrorStack LogOptions::load(tinyxml2::XMLElement* element) {
   EXTERNALIZE_LOAD_ELEMENT(element, log_buffer_kb_);
   EXTERNALIZE_LOAD_ELEMENT(element, log_file_size_mb_);
   EXTERNALIZE_LOAD_ELEMENT(element, flush_at_shutdown_);
+  EXTERNALIZE_LOAD_ELEMENT(element, coalesce_epoch_writes_);
+  EXTERNALIZE_LOAD_ELEMENT(element, coalesce_buffer_kb_);
+  EXTERNALIZE_LOAD_ELEMENT(element, persistent_memory_log_);
   CHECK_ERROR(get_child_element(element, "LogDeviceEmulationOptions", &emulation_))
   return kRetOk;
 }
@@ -87,6 +93,14 @@ ErrorStack LogOptions::save(tinyxml2::XMLElement* element) const {
   EXTERNALIZE_SAVE_ELEMENT(element, log_file_size_mb_, "Size in MB of files loggers write out");
   EXTERNALIZE_SAVE_ELEMENT(element, flush_at_shutdown_,
       "Whether to flush transaction logs and take savepoint when uninitialize() is called");
+  EXTERNALIZE_SAVE_ELEMENT(element, coalesce_epoch_writes_,
+    "Whether each logger gathers all logs of an epoch into one staging buffer and writes it"
+    " out in large sequential chunks, padding only at the end of the epoch.");
+  EXTERNALIZE_SAVE_ELEMENT(element, coalesce_buffer_kb_,
+    "Size in KB of the staging buffer used when coalesce_epoch_writes_ is true.");
+  EXTERNALIZE_SAVE_ELEMENT(element, persistent_memory_log_,
+    "Whether loggers map log files on persistent memory (DAX) and make epochs durable with"
+    " cache-line flushes and a fence instead of write+fsync.");
   CHECK_ERROR(add_child_element(element, "LogDeviceEmulationOptions",
           "[Experiments-only] Settings to emulate slower logging device", emulation_));
   return kRetOk;
@@ -37,6 +37,7 @@
 #include "foedus/debugging/stop_watch.hpp"
 #include "foedus/fs/direct_io_file.hpp"
 #include "foedus/fs/filesystem.hpp"
+#include "foedus/fs/persistent_memory_file.hpp"
 #include "foedus/log/common_log_types.hpp"
 #include "foedus/log/log_manager.hpp"
 #include "foedus/log/log_type.hpp"
@@ -75,6 +76,8 @@ ErrorStack Logger::initialize_once() {
   control_block_->initialize();
   // clear all variables
   current_file_ = nullptr;
+  current_pmem_file_ = nullptr;
+  persistent_memory_ = engine_->get_options().log_.persistent_memory_log_;
   LOG(INFO) << "Initializing Logger-" << id_ << ". assigned " << assigned_thread_ids_.size()
     << " threads, starting from " << assigned_thread_ids_[0] << ", numa_node_="
     << static_cast<int>(numa_node_);
@@ -94,20 +97,24 @@ ErrorStack Logger::initialize_once() {
     id_,
     control_block_->current_ordinal_);
   // open the log file
-  current_file_ = new fs::DirectIoFile(current_file_path_,
-                     engine_->get_options().log_.emulation_);
-  WRAP_ERROR_CODE(current_file_->open(true, true, true, true));
-  if (control_block_->current_file_durable_offset_ < current_file_->get_current_offset()) {
+  CHECK_ERROR(open_current_file());
+  if (control_block_->current_file_durable_offset_ < get_current_file_offset()) {
     // there are non-durable regions as an incomplete remnant of previous execution.
     // probably there was a crash. in this case, we discard the non-durable regions.
     LOG(ERROR) << "Logger-" << id_ << "'s log file has a non-durable region. Probably there"
       << " was a crash. Will truncate it to " << control_block_->current_file_durable_offset_
-      << " from " << current_file_->get_current_offset();
-    WRAP_ERROR_CODE(current_file_->truncate(
-      control_block_->current_file_durable_offset_,
-      true));  // sync right now
+      << " from " << get_current_file_offset();
+    if (persistent_memory_) {
+      WRAP_ERROR_CODE(current_pmem_file_->truncate(
+        control_block_->current_file_durable_offset_,
+        true));
+    } else {
+      WRAP_ERROR_CODE(current_file_->truncate(
+        control_block_->current_file_durable_offset_,
+        true));  // sync right now
+    }
   }
-  ASSERT_ND(control_block_->current_file_durable_offset_ == current_file_->get_current_offset());
+  ASSERT_ND(control_block_->current_file_durable_offset_ == get_current_file_offset());
   LOG(INFO) << "Initialized logger: " << *this;
 
   // which threads are assigned to me?
@@ -124,6 +131,19 @@ ErrorStack Logger::initialize_once() {
   ASSERT_ND(fill_buffer_.get_size() >= FillerLogType::kLogWriteUnitSize);
   ASSERT_ND(fill_buffer_.get_alignment() >= FillerLogType::kLogWriteUnitSize);
   LOG(INFO) << "Logger-" << id_ << " grabbed a padding buffer. size=" << fill_buffer_.get_size();
+
+  staging_used_ = 0;
+  const LogOptions& log_options = engine_->get_options().log_;
+  if (log_options.coalesce_epoch_writes_ && !persistent_memory_) {
+    uint64_t staging_kb = std::max<uint32_t>(log_options.coalesce_buffer_kb_, 4U);
+    uint64_t staging_size = align_log_floor(staging_kb << 10);
+    CHECK_ERROR(engine_->get_memory_manager()->get_local_memory()->allocate_numa_memory(
+      staging_size, &staging_buffer_));
+    ASSERT_ND(!staging_buffer_.is_null());
+    ASSERT_ND(staging_buffer_.get_alignment() >= FillerLogType::kLogWriteUnitSize);
+    LOG(INFO) << "Logger-" << id_ << " grabbed a staging buffer to coalesce epoch writes. size="
+      << staging_buffer_.get_size();
+  }
   CHECK_ERROR(write_dummy_epoch_mark());
 
   // log file and buffer prepared. let's launch the logger thread
@@ -143,12 +163,9 @@ ErrorStack Logger::uninitialize_once() {
     }
     logger_thread_.join();
   }
-  if (current_file_) {
-    current_file_->close();
-    delete current_file_;
-    current_file_ = nullptr;
-  }
+  close_current_file();
   fill_buffer_.release_block();
+  staging_buffer_.release_block();
   control_block_->uninitialize();
   return SUMMARIZE_ERROR_BATCH(batch);
 }
@@ -186,14 +203,14 @@ void Logger::handle_logger() {
 
       // just for debug out
       debugging::StopWatch watch;
-      uint64_t before_offset = (current_file_ ? current_file_-> get_current_offset() : 0);
+      uint64_t before_offset = get_current_file_offset();
 
       COERCE_ERROR(write_one_epoch(next_durable));
       ASSERT_ND(get_durable_epoch() == next_durable);
       COERCE_ERROR(switch_file_if_required());
 
       watch.stop();
-      uint64_t after_offset = (current_file_ ? current_file_-> get_current_offset() : 0);
+      uint64_t after_offset = get_current_file_offset();
       // LOG(INFO) was too noisy
       if (after_offset != before_offset) {
         VLOG(0) << "Logger-" << id_ << " wrote out " << (after_offset - before_offset)
@@ -219,11 +236,14 @@ ErrorStack Logger::update_durable_epoch(Epoch new_durable_epoch, bool had_any_lo
     VLOG(0) << "Logger-" << id_ << " updating durable_epoch_ from " << get_durable_epoch()
       << " to " << new_durable_epoch;
 
-    // BEFORE updating the epoch, fsync the file AND the parent folder
-    if (!fs::fsync(current_file_path_, true)) {
+    // BEFORE updating the epoch, fsync the file AND the parent folder.
+    // On persistent memory, the lines are already flushed. A fence is enough.
+    if (persistent_memory_) {
+      current_pmem_file_->persist();
+    } else if (!fs::fsync(current_file_path_, true)) {
       return ERROR_STACK_MSG(kErrorCodeFsSyncFailed, to_string().c_str());
     }
-    control_block_->current_file_durable_offset_ = current_file_->get_current_offset();
+    control_block_->current_file_durable_offset_ = get_current_file_offset();
     VLOG(0) << "Logger-" << id_ << " fsynced the current file ("
       << control_block_->current_file_durable_offset_ << "  bytes so far) and its folder";
     DVLOG(0) << "Before: " << *this;
@@ -232,7 +252,7 @@ ErrorStack Logger::update_durable_epoch(Epoch new_durable_epoch, bool had_any_lo
     VLOG(0) << "Logger-" << id_ << " had no log in this epoch. not writing an epoch mark."
       << " durable ep=" << get_durable_epoch() << ", new_epoch=" << new_durable_epoch
       << " marked ep=" << control_block_->marked_epoch_;
-    ASSERT_ND(control_block_->current_file_durable_offset_ == current_file_->get_current_offset());
+    ASSERT_ND(control_block_->current_file_durable_offset_ == get_current_file_offset());
   }
 
   ASSERT_ND(new_durable_epoch >= Epoch(control_block_->durable_epoch_));
@@ -277,14 +297,14 @@ ErrorStack Logger::log_epoch_switch(Epoch new_epoch) {
     in_node_ordinal_,
     id_,
     control_block_->current_ordinal_,
-    current_file_->get_current_offset());
+    get_current_file_offset());
 
   // Fill it up to 4kb and write. A bit wasteful, but happens only once per epoch
   FillerLogType* filler_log = reinterpret_cast<FillerLogType*>(buf
     + sizeof(EpochMarkerLogType));
   filler_log->populate(fill_buffer_.get_size() - sizeof(EpochMarkerLogType));
 
-  WRAP_ERROR_CODE(current_file_->write(fill_buffer_.get_size(), fill_buffer_));
+  WRAP_ERROR_CODE(write_to_current_file(fill_buffer_.get_size(), buf));
   control_block_->marked_epoch_ = new_epoch;
   add_epoch_history(*epoch_marker);
 
@@ -293,8 +313,8 @@ ErrorStack Logger::log_epoch_switch(Epoch new_epoch) {
 }
 
 ErrorStack Logger::switch_file_if_required() {
-  ASSERT_ND(current_file_);
-  if (current_file_->get_current_offset()
+  ASSERT_ND(current_file_ || current_pmem_file_);
+  if (get_current_file_offset()
       < (static_cast<uint64_t>(engine_->get_options().log_.log_file_size_mb_) << 20)) {
     return kRetOk;
   }
@@ -302,9 +322,7 @@ ErrorStack Logger::switch_file_if_required() {
   LOG(INFO) << "Logger-" << id_ << " moving on to next file. " << *this;
 
   // Close the current one. Immediately call fsync on it AND the parent folder.
-  current_file_->close();
-  delete current_file_;
-  current_file_ = nullptr;
+  close_current_file();
   control_block_->current_file_durable_offset_ = 0;
   if (!fs::fsync(current_file_path_, true)) {
     return ERROR_STACK_MSG(kErrorCodeFsSyncFailed, to_string().c_str());
@@ -315,10 +333,8 @@ ErrorStack Logger::switch_file_if_required() {
     id_,
     ++control_block_->current_ordinal_);
   LOG(INFO) << "Logger-" << id_ << " next file=" << current_file_path_;
-  current_file_ = new fs::DirectIoFile(current_file_path_,
-                      engine_->get_options().log_.emulation_);
-  WRAP_ERROR_CODE(current_file_->open(true, true, true, true));
-  ASSERT_ND(current_file_->get_current_offset() == 0);
+  CHECK_ERROR(open_current_file());
+  ASSERT_ND(get_current_file_offset() == 0);
   LOG(INFO) << "Logger-" << id_ << " moved on to next file. " << *this;
   CHECK_ERROR(write_dummy_epoch_mark());
   return kRetOk;
@@ -327,6 +343,9 @@ ErrorStack Logger::switch_file_if_required() {
 ErrorStack Logger::write_one_epoch(Epoch write_epoch) {
   ASSERT_ND(get_durable_epoch().one_more() == write_epoch);
   ASSERT_ND(write_epoch.one_more() < engine_->get_xct_manager()->get_current_global_epoch());
+  if (persistent_memory_ || !staging_buffer_.is_null()) {
+    return write_one_epoch_coalesced(write_epoch);
+  }
   bool had_any_log = false;
   for (thread::Thread* the_thread : assigned_threads_) {
     ThreadLogBuffer& buffer = the_thread->get_thread_log_buffer();
@@ -371,6 +390,147 @@ ErrorStack Logger::write_one_epoch(Epoch write_epoch) {
   return kRetOk;
 }
 
+ErrorStack Logger::write_one_epoch_coalesced(Epoch write_epoch) {
+  ASSERT_ND(staging_used_ == 0);
+  ASSERT_ND(is_log_aligned(get_current_file_offset()));
+  char* scratch = reinterpret_cast<char*>(fill_buffer_.get_block());
+  bool had_any_log = false;
+  for (thread::Thread* the_thread : assigned_threads_) {
+    ThreadLogBuffer& buffer = the_thread->get_thread_log_buffer();
+    ThreadLogBuffer::OffsetRange range = buffer.get_logs_to_write(write_epoch);
+    const uint64_t capacity = buffer.get_meta().buffer_size_;
+    if (range.begin_ > capacity || range.end_ > capacity) {
+      LOG(FATAL) << "Logger-" << id_ << " reported an invalid buffer range for epoch-"
+        << write_epoch << ". begin=" << range.begin_ << ", end=" << range.end_
+          << " while log buffer size=" << capacity << ". " << *this;
+    }
+
+    if (!range.is_empty()) {
+      if (had_any_log == false) {
+        // The epoch marker goes first while the staging buffer is empty, so its file offset
+        // is the current (aligned) offset of the file. No padding after it.
+        VLOG(1) << "Logger-" << id_ << " has a non-empty epoch-" << write_epoch;
+        had_any_log = true;
+        std::lock_guard<std::mutex> guard(epoch_switch_mutex_);
+        EpochMarkerLogType* epoch_marker = reinterpret_cast<EpochMarkerLogType*>(scratch);
+        epoch_marker->populate(
+          control_block_->marked_epoch_,
+          write_epoch,
+          numa_node_,
+          in_node_ordinal_,
+          id_,
+          control_block_->current_ordinal_,
+          get_current_file_offset());
+        WRAP_ERROR_CODE(append_to_staging(scratch, sizeof(EpochMarkerLogType)));
+        control_block_->marked_epoch_ = write_epoch;
+        add_epoch_history(*epoch_marker);
+      }
+
+      // A log entry never spans the end of the circular buffer (see reserve_new_log()),
+      // so a wrapped range is simply two back-to-back pieces.
+      const char* raw_buffer = buffer.get_buffer();
+      uint64_t first_end = range.begin_ < range.end_ ? range.end_ : capacity;
+      assert_written_logs(write_epoch, raw_buffer + range.begin_, first_end - range.begin_);
+      WRAP_ERROR_CODE(append_to_staging(raw_buffer + range.begin_, first_end - range.begin_));
+      if (range.begin_ >= range.end_) {
+        assert_written_logs(write_epoch, raw_buffer, range.end_);
+        WRAP_ERROR_CODE(append_to_staging(raw_buffer, range.end_));
+      }
+    }
+    // the logs are already copied to our staging buffer, so the thread can reuse the space
+    buffer.on_log_written(write_epoch);
+  }
+
+  // pad only once, at the end of the epoch. logs are all 8-byte aligned.
+  uint64_t pending_end = get_current_file_offset() + staging_used_;
+  uint64_t fill_size = align_log_ceil(pending_end) - pending_end;
+  if (fill_size > 0) {
+    ASSERT_ND(fill_size % 8 == 0);
+    FillerLogType* filler_log = reinterpret_cast<FillerLogType*>(scratch);
+    filler_log->populate(fill_size);
+    WRAP_ERROR_CODE(append_to_staging(scratch, fill_size));
+  }
+  if (staging_used_ > 0) {
+    ASSERT_ND(is_log_aligned(staging_used_));
+    WRAP_ERROR_CODE(write_to_current_file(staging_used_, staging_buffer_.get_block()));
+    staging_used_ = 0;
+  }
+  CHECK_ERROR(update_durable_epoch(write_epoch, had_any_log));
+  return kRetOk;
+}
+
+ErrorCode Logger::append_to_staging(const char* data, uint64_t bytes) {
+  if (persistent_memory_) {
+    // the mapping itself is our staging buffer
+    return current_pmem_file_->append(bytes, data);
+  }
+  char* staging = reinterpret_cast<char*>(staging_buffer_.get_block());
+  const uint64_t staging_size = staging_buffer_.get_size();
+  while (bytes > 0) {
+    ASSERT_ND(staging_used_ < staging_size);
+    uint64_t copy_size = std::min<uint64_t>(bytes, staging_size - staging_used_);
+    std::memcpy(staging + staging_used_, data, copy_size);
+    staging_used_ += copy_size;
+    data += copy_size;
+    bytes -= copy_size;
+    if (staging_used_ == staging_size) {
+      // A log entry might span two chunks. That's fine as the file is one contiguous stream.
+      CHECK_ERROR_CODE(write_to_current_file(staging_size, staging));
+      staging_used_ = 0;
+    }
+  }
+  return kErrorCodeOk;
+}
+
+ErrorStack Logger::open_current_file() {
+  ASSERT_ND(current_file_ == nullptr);
+  ASSERT_ND(current_pmem_file_ == nullptr);
+  if (persistent_memory_) {
+    current_pmem_file_ = new fs::PersistentMemoryFile(current_file_path_);
+    WRAP_ERROR_CODE(current_pmem_file_->open());
+    // we will not fsync the file afterwards, so make its existence durable right now
+    if (!fs::fsync(current_file_path_, true)) {
+      return ERROR_STACK_MSG(kErrorCodeFsSyncFailed, to_string().c_str());
+    }
+  } else {
+    current_file_ = new fs::DirectIoFile(current_file_path_,
+                      engine_->get_options().log_.emulation_);
+    WRAP_ERROR_CODE(current_file_->open(true, true, true, true));
+  }
+  return kRetOk;
+}
+
+void Logger::close_current_file() {
+  if (current_file_) {
+    current_file_->close();
+    delete current_file_;
+    current_file_ = nullptr;
+  }
+  if (current_pmem_file_) {
+    current_pmem_file_->close();
+    delete current_pmem_file_;
+    current_pmem_file_ = nullptr;
+  }
+}
+
+uint64_t Logger::get_current_file_offset() const {
+  if (current_file_) {
+    return current_file_->get_current_offset();
+  } else if (current_pmem_file_) {
+    return current_pmem_file_->get_current_offset();
+  } else {
+    return 0;
+  }
+}
+
+ErrorCode Logger::write_to_current_file(uint64_t bytes, const void* data) {
+  if (persistent_memory_) {
+    return current_pmem_file_->append(bytes, data);
+  } else {
+    return current_file_->write_raw(bytes, data);
+  }
+}
+
 ErrorStack Logger::write_one_epoch_piece(
   const ThreadLogBuffer& buffer,
   Epoch write_epoch,
@@ -518,10 +678,10 @@ void Logger::assert_consistent() {
   ASSERT_ND(control_block_->marked_epoch_.is_valid());
   ASSERT_ND(control_block_->marked_epoch_ <= get_durable_epoch().one_more());
   ASSERT_ND(is_log_aligned(control_block_->oldest_file_offset_begin_));
-  ASSERT_ND(current_file_ == nullptr || is_log_aligned(current_file_->get_current_offset()));
+  ASSERT_ND(is_log_aligned(get_current_file_offset()));
   ASSERT_ND(is_log_aligned(control_block_->current_file_durable_offset_));
-  ASSERT_ND(current_file_ == nullptr
-    || control_block_->current_file_durable_offset_ <= current_file_->get_current_offset());
+  ASSERT_ND((current_file_ == nullptr && current_pmem_file_ == nullptr)
+    || control_block_->current_file_durable_offset_ <= get_current_file_offset());
 #endif  // NDEBUG
 }
 
@@ -551,6 +711,8 @@ std::ostream& operator<<(std::ostream& o, const Logger& v) {
   o << "<current_file_>";
   if (v.current_file_) {
     o << *v.current_file_;
+  } else if (v.current_pmem_file_) {
+    o << *v.current_pmem_file_;
   } else {
     o << "nullptr";
   }
@@ -558,13 +720,7 @@ std::ostream& operator<<(std::ostream& o, const Logger& v) {
 
   o << "<current_file_path_>" << v.current_file_path_ << "</current_file_path_>";
 
-  o << "<current_file_length_>";
-  if (v.current_file_) {
-    o << v.current_file_->get_current_offset();
-  } else {
-    o << "nullptr";
-  }
-  o << "</current_file_length_>";
+  o << "<current_file_length_>" << v.get_current_file_offset() << "</current_file_length_>";
 
   o << "<epoch_history_head>"
     << v.control_block_->epoch_history_head_ << "</epoch_history_head>";
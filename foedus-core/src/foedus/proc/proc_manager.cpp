@@ -40,6 +40,12 @@ ErrorStack  ProcManager::uninitialize() { return pimpl_->uninitialize(); }
 ErrorStack  ProcManager::get_proc(const ProcName& name, Proc* out) {
   return pimpl_->get_proc(name, out);
 }
+ErrorStack  ProcManager::get_proc_by_local_id(LocalProcId id, Proc* out) {
+  return pimpl_->get_proc_by_local_id(id, out);
+}
+ErrorStack  ProcManager::get_local_proc_id(uint16_t node, const ProcName& name, LocalProcId* out) {
+  return pimpl_->get_local_proc_id(node, name, out);
+}
 
 ErrorStack  ProcManager::pre_register(const ProcAndName& proc_and_name) {
   return pimpl_->pre_register(proc_and_name);
@@ -54,6 +60,14 @@ ErrorStack  ProcManager::emulated_register(const ProcAndName& proc_and_name) {
 const std::vector< ProcAndName >& ProcManager::get_pre_registered_procedures() const {
   return pimpl_->pre_registered_procs_;
 }
+
+ErrorStack  ProcManager::load_shared_library(const std::string& path) {
+  return pimpl_->load_shared_library(path);
+}
+uint32_t    ProcManager::get_library_version(uint16_t node) const {
+  return pimpl_->get_library_version(node);
+}
+
 std::string ProcManager::describe_registered_procs() const {
   return pimpl_->describe_registered_procs();
 }
@@ -17,17 +17,25 @@
  */
 #include "foedus/proc/proc_manager_pimpl.hpp"
 
+#include <dlfcn.h>
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "foedus/compiler.hpp"
 #include "foedus/engine.hpp"
 #include "foedus/engine_options.hpp"
 #include "foedus/epoch.hpp"
 #include "foedus/error_stack_batch.hpp"
 #include "foedus/assorted/atomic_fences.hpp"
 #include "foedus/assorted/dumb_spinlock.hpp"
+#include "foedus/fs/filesystem.hpp"
+#include "foedus/fs/path.hpp"
+#include "foedus/proc/proc_options.hpp"
 #include "foedus/soc/soc_manager.hpp"
 
 namespace foedus {
@@ -49,18 +57,23 @@ ErrorStack ProcManagerPimpl::initialize_once() {
   if (!engine_->is_master()) {
     LOG(INFO) << "Initializing ProcManager(" << engine_->describe_short() << ")..";
     get_local_data()->control_block_->initialize();
+    CHECK_ERROR(load_shared_libraries_in_options());
   }
-
-  // TODO(Hideaki) load shared libraries
   return kRetOk;
 }
 
 ErrorStack ProcManagerPimpl::uninitialize_once() {
   ErrorStackBatch batch;
-  // TODO(Hideaki) unload shared libraries
   if (!engine_->is_master()) {
     LOG(INFO) << "Uninitializing ProcManager(" << engine_->describe_short() << ")..";
     get_local_data()->control_block_->uninitialize();
+    // Nothing runs procedures any more, so we can now unload them.
+    for (void* handle : library_handles_) {
+      if (::dlclose(handle) != 0) {
+        LOG(WARNING) << "dlclose() failed: " << ::dlerror();
+      }
+    }
+    library_handles_.clear();
     return kRetOk;
   }
   all_soc_procs_.clear();
@@ -70,13 +83,37 @@ ErrorStack ProcManagerPimpl::uninitialize_once() {
 
 ErrorStack  ProcManagerPimpl::get_proc(const ProcName& name, Proc* out) {
   soc::SocId node = engine_->get_soc_id();
-  LocalProcId id = find_by_name(name, &all_soc_procs_[node]);
+  LocalProcId id = find_by_name_with_lock(name, &all_soc_procs_[node]);
   if (id == kLocalProcInvalid) {
     return ERROR_STACK_MSG(kErrorCodeProcNotFound, name.c_str());
   }
   *out = all_soc_procs_[node].procs_[id].second;
   return kRetOk;
 }
+ErrorStack  ProcManagerPimpl::get_proc_by_local_id(LocalProcId id, Proc* out) {
+  SharedData* data = &all_soc_procs_[engine_->get_soc_id()];
+  // Procedures are only appended, so an ID below count_ is always valid.
+  LocalProcId count = data->control_block_->count_;
+  assorted::memory_fence_acquire();
+  if (UNLIKELY(id >= count)) {
+    return ERROR_STACK(kErrorCodeProcNotFound);
+  }
+  *out = data->procs_[id].second;
+  return kRetOk;
+}
+ErrorStack  ProcManagerPimpl::get_local_proc_id(
+  soc::SocId node,
+  const ProcName& name,
+  LocalProcId* out) {
+  if (node >= all_soc_procs_.size()) {
+    return ERROR_STACK_MSG(kErrorCodeProcNotFound, name.c_str());
+  }
+  *out = find_by_name_with_lock(name, &all_soc_procs_[node]);
+  if (*out == kLocalProcInvalid) {
+    return ERROR_STACK_MSG(kErrorCodeProcNotFound, name.c_str());
+  }
+  return kRetOk;
+}
 ProcManagerPimpl::SharedData* ProcManagerPimpl::get_local_data() {
   ASSERT_ND(!engine_->is_master());
   return &all_soc_procs_[engine_->get_soc_id()];
@@ -143,29 +180,197 @@ ErrorStack  ProcManagerPimpl::emulated_register(const ProcAndName& proc_and_name
   return kRetOk;
 }
 
-LocalProcId ProcManagerPimpl::find_by_name(const ProcName& name, SharedData* shared_data) {
-  // so far just a seqnetial search.
-  LocalProcId count = shared_data->control_block_->count_;
+ErrorStack  ProcManagerPimpl::load_shared_library(const std::string& path) {
+  if (!is_initialized()) {
+    LOG(ERROR) << "Incorrect use of load_shared_library(): "
+      << get_error_message(kErrorCodeProcRegisterTooEarly);
+    return ERROR_STACK(kErrorCodeProcRegisterTooEarly);
+  }
+  if (engine_->is_master()) {
+    LOG(ERROR) << "Incorrect use of load_shared_library(): "
+      << get_error_message(kErrorCodeProcRegisterChildOnly);
+    return ERROR_STACK(kErrorCodeProcRegisterChildOnly);
+  }
+  return dlopen_and_register(path);
+}
+
+ErrorStack  ProcManagerPimpl::load_shared_libraries_in_options() {
+  const ProcOptions& options = engine_->get_options().proc_;
+  soc::SocId node = engine_->get_soc_id();
+  std::vector< std::string > paths;
+  std::string token;
+  std::stringstream path_str(options.convert_shared_library_path_pattern(node));
+  while (std::getline(path_str, token, ';')) {
+    if (!token.empty()) {
+      paths.push_back(token);
+    }
+  }
+
+  std::stringstream dir_str(options.convert_shared_library_dir_pattern(node));
+  while (std::getline(dir_str, token, ';')) {
+    if (token.empty()) {
+      continue;
+    }
+    fs::Path dir(token);
+    if (!fs::is_directory(dir)) {
+      LOG(ERROR) << "Not a directory: " << dir;
+      return ERROR_STACK_MSG(kErrorCodeProcLibraryLoadFailed, dir.c_str());
+    }
+    std::vector< fs::Path > children = dir.child_paths();
+    // Load them in a deterministic order. Later ones override earlier ones.
+    std::sort(children.begin(), children.end(), [](const fs::Path& a, const fs::Path& b) {
+      return a.string() < b.string();
+    });
+    for (const fs::Path& child : children) {
+      const std::string& child_str = child.string();
+      if (child_str.size() > 3U && child_str.compare(child_str.size() - 3U, 3U, ".so") == 0) {
+        paths.push_back(child_str);
+      }
+    }
+  }
+
+  for (const std::string& path : paths) {
+    CHECK_ERROR(dlopen_and_register(path));
+  }
+  return kRetOk;
+}
+
+ErrorStack  ProcManagerPimpl::dlopen_and_register(const std::string& path) {
+  void* handle = ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) {
+    std::string message(::dlerror());
+    LOG(ERROR) << "dlopen() failed: " << message;
+    return ERROR_STACK_MSG(kErrorCodeProcLibraryLoadFailed, message.c_str());
+  }
+  ProcLibraryInitFunc init_func = reinterpret_cast<ProcLibraryInitFunc>(
+    ::dlsym(handle, kProcLibraryInitFuncName));
+  if (init_func == nullptr) {
+    LOG(ERROR) << path << " doesn't export " << kProcLibraryInitFuncName;
+    ::dlclose(handle);
+    return ERROR_STACK_MSG(kErrorCodeProcLibraryLoadFailed, path.c_str());
+  }
+
+  std::vector< ProcAndName > procs(kMaxProcsPerLibrary);
+  uint32_t count = init_func(&procs[0], kMaxProcsPerLibrary);
+  if (count > kMaxProcsPerLibrary) {
+    LOG(ERROR) << path << " declared too many procedures: " << count;
+    ::dlclose(handle);
+    return ERROR_STACK_MSG(kErrorCodeProcLibraryLoadFailed, path.c_str());
+  }
+
+  // Once its procedures are registered, we can't close the library until the engine stops.
+  library_handles_.push_back(handle);
+  SharedData* data = get_local_data();
+  for (uint32_t i = 0; i < count; ++i) {
+    bool replaced = false;
+    LocalProcId id = upsert(procs[i], data, &replaced);
+    if (id == kLocalProcInvalid) {
+      return ERROR_STACK_MSG(kErrorCodeProcLibraryLoadFailed, procs[i].first.c_str());
+    }
+    LOG(INFO) << (replaced ? "replaced" : "registered") << " a user procedure from " << path
+      << ": " << procs[i].first;
+  }
+  {
+    soc::SharedMutexScope lock_scope(&data->control_block_->lock_);
+    ++data->control_block_->library_version_;
+  }
+  return kRetOk;
+}
+
+uint32_t ProcManagerPimpl::get_library_version(soc::SocId node) const {
+  ASSERT_ND(node < all_soc_procs_.size());
+  uint32_t version = all_soc_procs_[node].control_block_->library_version_;
   assorted::memory_fence_acquire();
-  for (LocalProcId i = 0; i < count; ++i) {
-    if (shared_data->procs_[i].first == name) {
-      return i;
+  return version;
+}
+
+namespace {
+/** Returns the first position in name_sort_ whose name is not less than the given name. */
+LocalProcId lower_bound_by_name(
+  const ProcName& name,
+  const ProcAndName* procs,
+  const LocalProcId* name_sort,
+  LocalProcId count) {
+  LocalProcId low = 0;
+  LocalProcId high = count;
+  while (low < high) {
+    LocalProcId mid = low + (high - low) / 2U;
+    if (procs[name_sort[mid]].first < name) {
+      low = mid + 1U;
+    } else {
+      high = mid;
     }
   }
+  return low;
+}
+}  // namespace
+
+LocalProcId ProcManagerPimpl::find_by_name(const ProcName& name, SharedData* shared_data) {
+  LocalProcId count = shared_data->control_block_->count_;
+  LocalProcId pos = lower_bound_by_name(name, shared_data->procs_, shared_data->name_sort_, count);
+  if (pos < count && shared_data->procs_[shared_data->name_sort_[pos]].first == name) {
+    return shared_data->name_sort_[pos];
+  }
   return kLocalProcInvalid;
 }
 
+LocalProcId ProcManagerPimpl::find_by_name_with_lock(
+  const ProcName& name,
+  SharedData* shared_data) {
+  soc::SharedMutexScope lock_scope(&shared_data->control_block_->lock_);
+  return find_by_name(name, shared_data);
+}
+
 LocalProcId ProcManagerPimpl::insert(const ProcAndName& proc_and_name, SharedData* shared_data) {
   soc::SharedMutexScope lock_scope(&shared_data->control_block_->lock_);
-  LocalProcId found = find_by_name(proc_and_name.first, shared_data);
-  // TASK(Hideaki) max_proc_count check.
-  if (found != kLocalProcInvalid) {
+  const ProcAndName* procs = shared_data->procs_;
+  const LocalProcId* name_sort = shared_data->name_sort_;
+  LocalProcId count = shared_data->control_block_->count_;
+  LocalProcId pos = lower_bound_by_name(proc_and_name.first, procs, name_sort, count);
+  if (pos < count && procs[name_sort[pos]].first == proc_and_name.first) {
     return kLocalProcInvalid;
   }
-  LocalProcId new_id = shared_data->control_block_->count_;
+  return append_sorted(proc_and_name, pos, shared_data);
+}
+
+LocalProcId ProcManagerPimpl::upsert(
+  const ProcAndName& proc_and_name,
+  SharedData* shared_data,
+  bool* replaced) {
+  soc::SharedMutexScope lock_scope(&shared_data->control_block_->lock_);
+  const ProcAndName* procs = shared_data->procs_;
+  const LocalProcId* name_sort = shared_data->name_sort_;
+  LocalProcId count = shared_data->control_block_->count_;
+  LocalProcId pos = lower_bound_by_name(proc_and_name.first, procs, name_sort, count);
+  if (pos < count && procs[name_sort[pos]].first == proc_and_name.first) {
+    // Same name. Just replace the function pointer. Threads that look it up by ID without
+    // lock see either the old or new pointer, both of which stay valid.
+    *replaced = true;
+    LocalProcId id = name_sort[pos];
+    assorted::atomic_store_release<Proc>(&shared_data->procs_[id].second, proc_and_name.second);
+    return id;
+  }
+  *replaced = false;
+  return append_sorted(proc_and_name, pos, shared_data);
+}
+
+LocalProcId ProcManagerPimpl::append_sorted(
+  const ProcAndName& proc_and_name,
+  LocalProcId pos,
+  SharedData* shared_data) {
+  // TASK(Hideaki) max_proc_count check.
+  LocalProcId count = shared_data->control_block_->count_;
+  ASSERT_ND(pos <= count);
+  LocalProcId new_id = count;
   shared_data->procs_[new_id] = proc_and_name;
-  ++shared_data->control_block_->count_;
-  // TASK(Hideaki) insert-sort to name_sort
+  std::memmove(
+    shared_data->name_sort_ + pos + 1U,
+    shared_data->name_sort_ + pos,
+    sizeof(LocalProcId) * (count - pos));
+  shared_data->name_sort_[pos] = new_id;
+  // Readers via ID don't take lock. Publish count_ after the entry.
+  assorted::memory_fence_release();
+  shared_data->control_block_->count_ = count + 1U;
   return new_id;
 }
 
@@ -490,12 +490,24 @@ void LogMapper::flush_bucket(const BucketHashList& hashlist) {
           partition_array};
         partitioner.partition_batch(args);
 
-        // sort the log positions by the calculated partitions
-        std::memset(sort_array, 0, sizeof(PartitionSortEntry) * bucket->counts_);
+        // sort the log positions by the calculated partitions.
+        // there are only a few partitions, so a counting sort (stable, O(n)) is enough.
+        uint32_t partition_offsets[1U << (sizeof(storage::PartitionId) * 8U)];
+        std::memset(partition_offsets, 0, sizeof(partition_offsets));
         for (uint32_t i = 0; i < bucket->counts_; ++i) {
-          sort_array[i].set(partition_array[i], bucket->log_positions_[i]);
+          ++partition_offsets[partition_array[i]];
+        }
+        uint32_t total = 0;
+        for (uint32_t p = 0; p < (1U << (sizeof(storage::PartitionId) * 8U)); ++p) {
+          uint32_t partition_count = partition_offsets[p];
+          partition_offsets[p] = total;
+          total += partition_count;
+        }
+        ASSERT_ND(total == bucket->counts_);
+        for (uint32_t i = 0; i < bucket->counts_; ++i) {
+          uint32_t dest = partition_offsets[partition_array[i]]++;
+          sort_array[dest].set(partition_array[i], bucket->log_positions_[i]);
         }
-        std::sort(sort_array, sort_array + bucket->counts_);
 
         // let's reuse the current bucket as a temporary memory to hold sorted entries.
         // buckets are discarded after the flushing, so this doesn't cause any issue.
@@ -24,6 +24,7 @@
 #include "foedus/epoch.hpp"
 #include "foedus/assorted/assorted_func.hpp"
 #include "foedus/assorted/cacheline.hpp"
+#include "foedus/assorted/radix_sort.hpp"
 #include "foedus/debugging/stop_watch.hpp"
 #include "foedus/memory/aligned_memory.hpp"
 #include "foedus/snapshot/log_buffer.hpp"
@@ -68,7 +69,8 @@ MergeSort::MergeSort(
   uint16_t inputs_count,
   uint16_t max_original_pages,
   memory::AlignedMemory* const work_memory,
-  uint16_t chunk_batch_size)
+  uint16_t chunk_batch_size,
+  uint16_t sort_threads)
   : DefaultInitializable(),
     id_(id),
     type_(type),
@@ -79,13 +81,15 @@ MergeSort::MergeSort(
     inputs_count_(inputs_count),
     max_original_pages_(max_original_pages),
     chunk_batch_size_(chunk_batch_size),
-    work_memory_(work_memory) {
+    work_memory_(work_memory),
+    sort_threads_(sort_threads) {
   ASSERT_ND(shortest_key_length_ <= longest_key_length_);
   ASSERT_ND(shortest_key_length_ > 0);
   ASSERT_ND(chunk_batch_size_ > 0);
   current_count_ = 0;
   sort_entries_ = nullptr;
   position_entries_ = nullptr;
+  radix_buffer_ = nullptr;
   original_pages_ = nullptr;
   inputs_status_ = nullptr;
 }
@@ -95,7 +99,7 @@ ErrorStack MergeSort::initialize_once() {
   // it (at most kLogChunk-1 such tuples). so, conservatively chunk_batch_size_ + inputs_count_.
   uint32_t buffer_capacity = kLogChunk * (chunk_batch_size_ + inputs_count_);
   buffer_capacity_ = assorted::align<uint32_t, 512U>(buffer_capacity);
-  uint64_t byte_size = buffer_capacity_ * (sizeof(SortEntry) + sizeof(PositionEntry));
+  uint64_t byte_size = buffer_capacity_ * (sizeof(SortEntry) * 2U + sizeof(PositionEntry));
   ASSERT_ND(byte_size % 4096U == 0);
   byte_size += storage::kPageSize * (max_original_pages_ + 1U);
   byte_size += sizeof(InputStatus) * inputs_count_;
@@ -111,6 +115,8 @@ ErrorStack MergeSort::initialize_once() {
   offset += sizeof(SortEntry) * buffer_capacity;
   position_entries_ = reinterpret_cast<PositionEntry*>(block + offset);
   offset += sizeof(PositionEntry) * buffer_capacity;
+  radix_buffer_ = reinterpret_cast<SortEntry*>(block + offset);
+  offset += sizeof(SortEntry) * buffer_capacity;
   original_pages_ = reinterpret_cast<storage::Page*>(block + offset);
   offset += sizeof(storage::Page) * (max_original_pages_ + 1U);
   inputs_status_ = reinterpret_cast<InputStatus*>(block + offset);
@@ -413,10 +419,15 @@ void MergeSort::batch_sort(MergeSort::InputIndex min_input) {
   batch_sort_prepare(min_input);
   ASSERT_ND(current_count_ <= buffer_capacity_);
 
-  // First, sort it with std::sort, which is (*) smart enough to switch to heap sort for this case.
-  // (*) at least gcc's does.
+  // First, radix-sort it. Entries are initially in the order of their positions, the lowest 23
+  // bits. So, a stable sort on the other bits gives the same result without the 2 lowest bytes.
   debugging::StopWatch sort_watch;
-  std::sort(&(sort_entries_->data_), &(sort_entries_[current_count_].data_));
+  assorted::radix_sort_uint128(
+    &(sort_entries_->data_),
+    &(radix_buffer_->data_),
+    current_count_,
+    2U,
+    sort_threads_);
   sort_watch.stop();
   VLOG(1) << "Storage-" << id_ << ", merge sort (main) of " << current_count_ << " logs in "
     << sort_watch.elapsed_ms() << "ms";
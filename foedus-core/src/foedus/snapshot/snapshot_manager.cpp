@@ -55,5 +55,9 @@ void SnapshotManager::trigger_snapshot_immediate(
   pimpl_->trigger_snapshot_immediate(wait_completion, suggested_snapshot_epoch);
 }
 
+void SnapshotManager::trigger_eviction_immediate(bool wait_completion) {
+  pimpl_->trigger_eviction_immediate(wait_completion);
+}
+
 }  // namespace snapshot
 }  // namespace foedus
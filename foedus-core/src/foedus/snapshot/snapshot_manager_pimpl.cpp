@@ -48,6 +48,7 @@
 #include "foedus/storage/composer.hpp"
 #include "foedus/storage/metadata.hpp"
 #include "foedus/storage/partitioner.hpp"
+#include "foedus/storage/storage.hpp"
 #include "foedus/storage/storage_manager.hpp"
 #include "foedus/thread/numa_thread_scope.hpp"
 #include "foedus/xct/xct_manager.hpp"
@@ -74,6 +75,11 @@ ErrorStack SnapshotManagerPimpl::initialize_once() {
       = engine_->get_savepoint_manager()->get_latest_snapshot_id();
     LOG(INFO) << "Latest snapshot: id=" << control_block_->previous_snapshot_id_ << ", epoch="
       << control_block_->snapshot_epoch_;
+    // valid-until epochs of older snapshots are loaded on demand. see load_snapshot_epochs()
+    snapshot_epochs_.assign(1U << (sizeof(SnapshotId) * 8U), Epoch::kEpochInvalid);
+    if (control_block_->previous_snapshot_id_ != kNullSnapshotId) {
+      snapshot_epochs_[control_block_->previous_snapshot_id_] = control_block_->snapshot_epoch_;
+    }
     control_block_->requested_snapshot_epoch_.store(Epoch::kEpochInvalid);
 
     const EngineOptions& options = engine_->get_options();
@@ -103,6 +109,7 @@ ErrorStack SnapshotManagerPimpl::initialize_once() {
 
   // in child engines, we instantiate local mappers/reducer objects (but not the threads yet)
   previous_snapshot_time_ = std::chrono::system_clock::now();
+  previous_eviction_time_ = previous_snapshot_time_;
   stop_requested_ = false;
   if (!engine_->is_master()) {
     local_reducer_ = new LogReducer(engine_);
@@ -231,6 +238,29 @@ void SnapshotManagerPimpl::handle_snapshot() {
     } else {
       VLOG(1) << "Snapshotting not triggered. going to sleep again";
     }
+
+    // Also, should we evict cold volatile pages? We don't do it more than once a second
+    // unless explicitly requested, because each eviction pauses transactions.
+    uint64_t requested_evictions = control_block_->requested_evictions_.load();
+    bool evict = false;
+    if (requested_evictions > control_block_->completed_evictions_.load()) {
+      evict = true;
+      LOG(INFO) << "Immediate eviction request detected. evicting..";
+    } else if (std::chrono::system_clock::now()
+        >= previous_eviction_time_ + std::chrono::seconds(1)
+      && is_volatile_pool_short()) {
+      evict = true;
+      LOG(INFO) << "Volatile pool is running short of free pages. evicting..";
+    }
+    if (evict) {
+      ErrorStack stack = evict_volatile_pages();
+      if (stack.is_error()) {
+        LOG(ERROR) << "Eviction failed:" << stack;
+      }
+      previous_eviction_time_ = std::chrono::system_clock::now();
+      control_block_->completed_evictions_.store(requested_evictions);
+      control_block_->eviction_done_.signal();
+    }
   }
 
   LOG(INFO) << "Snapshot daemon ended. ";
@@ -313,6 +343,21 @@ void SnapshotManagerPimpl::trigger_snapshot_immediate(
   LOG(INFO) << "Observed the completion of snapshot! after=" << get_snapshot_epoch();
 }
 
+void SnapshotManagerPimpl::trigger_eviction_immediate(bool wait_completion) {
+  uint64_t ticket = ++control_block_->requested_evictions_;
+  LOG(INFO) << "Requesting to immediately evict cold volatile pages. ticket=" << ticket;
+  wakeup();
+  if (wait_completion) {
+    while (!is_stop_requested() && control_block_->completed_evictions_.load() < ticket) {
+      uint64_t demand = control_block_->eviction_done_.acquire_ticket();
+      if (!is_stop_requested() && control_block_->completed_evictions_.load() < ticket) {
+        control_block_->eviction_done_.timedwait(demand, 100000ULL);
+      }
+    }
+    LOG(INFO) << "Observed the completion of eviction. ticket=" << ticket;
+  }
+}
+
 ErrorStack SnapshotManagerPimpl::handle_snapshot_triggered(Snapshot *new_snapshot) {
   ASSERT_ND(engine_->is_master());
   ASSERT_ND(engine_->get_storage_manager()->is_initialized());  // snapshot relied on storage module
@@ -375,6 +420,7 @@ ErrorStack SnapshotManagerPimpl::handle_snapshot_triggered(Snapshot *new_snapsho
   // done. notify waiters if exist
   Epoch::EpochInteger epoch_after = new_snapshot_epoch.value();
   control_block_->previous_snapshot_id_ = snapshot_id;
+  snapshot_epochs_[snapshot_id] = epoch_after;
   previous_snapshot_time_ = std::chrono::system_clock::now();
 
   control_block_->snapshot_epoch_ = epoch_after;
@@ -574,7 +620,9 @@ ErrorStack SnapshotManagerPimpl::drop_volatile_pages(
       0,
       false,
       dropped_chunks,
-      &dropped_count};
+      &dropped_count,
+      false,
+      nullptr};
     storage::Composer composer(engine_, id);
     composer.drop_root_volatile(args);
     LOG(INFO) << "As a result, we dropped " << dropped_count << " pages from storage-" << id;
@@ -635,7 +683,9 @@ void SnapshotManagerPimpl::drop_volatile_pages_parallel(
         parallel_id,
         true,
         dropped_chunks,
-        &dropped_count};
+        &dropped_count,
+        false,
+        nullptr};
       debugging::StopWatch watch;
       storage::Composer::DropResult result = composer.drop_volatiles(args);
       ASSERT_ND(engine_->get_storage_manager()->get_storage(id)->root_page_pointer_.
@@ -674,5 +724,169 @@ void SnapshotManagerPimpl::drop_volatile_pages_parallel(
   chunks_memory.release_block();
 }
 
+bool SnapshotManagerPimpl::is_volatile_pool_short() const {
+  const uint16_t percent = get_option().evict_page_pool_percent_;
+  if (percent == 0) {
+    return false;
+  }
+  for (uint16_t node = 0; node < engine_->get_soc_count(); ++node) {
+    memory::PagePool::Stat stat
+      = engine_->get_memory_manager()->get_node_memory(node)->get_volatile_pool()->get_stat();
+    // roughly calculated. pages cached in each core's local chunk are deemed as allocated.
+    uint64_t free_pages = stat.total_pages_ - stat.allocated_pages_;
+    if (free_pages * 100U < stat.total_pages_ * percent) {
+      VLOG(0) << "Node-" << node << " has only " << free_pages << " free volatile pages out of "
+        << stat.total_pages_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void SnapshotManagerPimpl::load_snapshot_epochs() {
+  // Snapshots taken after this engine started are already there.
+  // We walk back from the latest until we hit a snapshot we know or a missing metadata file.
+  const SnapshotId latest = get_previous_snapshot_id();
+  ASSERT_ND(latest != kNullSnapshotId);
+  ASSERT_ND(snapshot_epochs_[latest] != Epoch::kEpochInvalid);
+  for (SnapshotId id = static_cast<SnapshotId>(latest - 1U);
+        id != kNullSnapshotId && snapshot_epochs_[id] == Epoch::kEpochInvalid;
+        --id) {
+    if (!fs::exists(get_snapshot_metadata_file_path(id))) {
+      VLOG(0) << "Snapshot metadata file of snapshot-" << id << " doesn't exist";
+      break;
+    }
+    SnapshotMetadata metadata;
+    ErrorStack stack = read_snapshot_metadata(id, &metadata);
+    if (stack.is_error()) {
+      LOG(WARNING) << "Failed to read snapshot metadata of snapshot-" << id << ":" << stack;
+      break;
+    }
+    snapshot_epochs_[id] = metadata.valid_until_epoch_;
+  }
+}
+
+ErrorStack SnapshotManagerPimpl::evict_volatile_pages() {
+  ASSERT_ND(engine_->is_master());
+  Snapshot latest_snapshot;
+  latest_snapshot.clear();
+  latest_snapshot.id_ = get_previous_snapshot_id();
+  if (latest_snapshot.id_ == kNullSnapshotId) {
+    LOG(INFO) << "No snapshot has been taken yet. Nothing can be evicted";
+    return kRetOk;
+  }
+  latest_snapshot.valid_until_epoch_ = get_snapshot_epoch();
+  ASSERT_ND(latest_snapshot.valid_until_epoch_.is_valid());
+
+  // Only storages that opted in and have been snapshotted are subject to eviction.
+  // Sequential storage drops all volatile pages at each snapshot anyway.
+  storage::StorageManager* storage_manager = engine_->get_storage_manager();
+  latest_snapshot.max_storage_id_ = storage_manager->get_largest_storage_id();
+  std::vector<storage::StorageId> storages;
+  for (storage::StorageId id = 1; id <= latest_snapshot.max_storage_id_; ++id) {
+    storage::StorageControlBlock* block = storage_manager->get_storage(id);
+    if (!block->exists()
+      || block->meta_.type_ == storage::kSequentialStorage
+      || block->meta_.keeps_all_volatile_pages()
+      || block->meta_.snapshot_thresholds_.evict_hotness_threshold_ == 0
+      || block->root_page_pointer_.snapshot_pointer_ == 0) {
+      continue;
+    }
+    storages.push_back(id);
+  }
+  if (storages.empty()) {
+    LOG(INFO) << "No storage is configured to evict volatile pages";
+    return kRetOk;
+  }
+  load_snapshot_epochs();
+
+  // Same as drop_volatile_pages(). We pause transaction executions while dropping pages.
+  engine_->get_xct_manager()->pause_accepting_xct();
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  LOG(INFO) << "Paused transaction executions to evict cold volatile pages of "
+    << storages.size() << " storages as of snapshot-" << latest_snapshot.id_;
+  debugging::StopWatch stop_watch;
+
+  const uint16_t soc_count = engine_->get_soc_count();
+  std::vector<uint64_t> dropped_counts(soc_count, 0);
+  std::vector< std::thread > threads;
+  for (uint16_t node = 0; node < soc_count; ++node) {
+    threads.emplace_back(
+      &SnapshotManagerPimpl::evict_volatile_pages_parallel,
+      this,
+      latest_snapshot,
+      storages,
+      node,
+      &dropped_counts[node]);
+  }
+  for (std::thread& thr : threads) {
+    thr.join();
+  }
+
+  engine_->get_xct_manager()->resume_accepting_xct();
+  stop_watch.stop();
+
+  uint64_t dropped_count_total = 0;
+  for (uint16_t node = 0; node < soc_count; ++node) {
+    dropped_count_total += dropped_counts[node];
+  }
+  LOG(INFO) << "Evicted " << dropped_count_total << " cold volatile pages in "
+    << stop_watch.elapsed_ms() << "ms.";
+  return kRetOk;
+}
+
+void SnapshotManagerPimpl::evict_volatile_pages_parallel(
+  const Snapshot& latest_snapshot,
+  const std::vector<storage::StorageId>& storages,
+  uint16_t parallel_id,
+  uint64_t* dropped_count) {
+  thread::NumaThreadScope numa_scope(parallel_id);
+  const uint16_t soc_count = engine_->get_soc_count();
+
+  memory::AlignedMemory chunks_memory;
+  chunks_memory.alloc(
+    sizeof(memory::PagePoolOffsetChunk) * soc_count,
+    1U << 12,
+    memory::AlignedMemory::kNumaAllocOnnode,
+    parallel_id);
+  memory::PagePoolOffsetChunk* dropped_chunks = reinterpret_cast<memory::PagePoolOffsetChunk*>(
+    chunks_memory.get_block());
+  for (uint16_t node = 0; node < soc_count; ++node) {
+    dropped_chunks[node].clear();
+  }
+
+  // Unlike drop_volatile_pages(), partitioning information might not be there (eg right after
+  // restart). So, each thread takes a subset of storages rather than a partition of each storage.
+  *dropped_count = 0;
+  for (uint32_t i = parallel_id; i < storages.size(); i += soc_count) {
+    storage::StorageId id = storages[i];
+    storage::Composer composer(engine_, id);
+    uint64_t storage_dropped_count = 0;
+    storage::Composer::DropVolatilesArguments args = {
+      latest_snapshot,
+      parallel_id,
+      false,
+      dropped_chunks,
+      &storage_dropped_count,
+      true,
+      &snapshot_epochs_[0]};
+    storage::Composer::DropResult result = composer.drop_volatiles(args);
+    VLOG(0) << "Thread-" << parallel_id << " evicted " << storage_dropped_count
+      << " volatile pages from storage-" << id << ". result =" << result;
+    *dropped_count += storage_dropped_count;
+  }
+
+  for (uint16_t node = 0; node < soc_count; ++node) {
+    memory::PagePoolOffsetChunk* chunk = dropped_chunks + node;
+    memory::PagePool* volatile_pool
+      = engine_->get_memory_manager()->get_node_memory(node)->get_volatile_pool();
+    if (!chunk->empty()) {
+      volatile_pool->release(chunk->size(), chunk);
+    }
+    ASSERT_ND(chunk->empty());
+  }
+  chunks_memory.release_block();
+}
+
 }  // namespace snapshot
 }  // namespace foedus
@@ -26,6 +26,7 @@ namespace snapshot {
 SnapshotOptions::SnapshotOptions() {
   folder_path_pattern_ = "snapshots/node_$NODE$";
   snapshot_trigger_page_pool_percent_ = kDefaultSnapshotTriggerPagePoolPercent;
+  evict_page_pool_percent_ = kDefaultEvictPagePoolPercent;
   snapshot_interval_milliseconds_ = kDefaultSnapshotIntervalMilliseconds;
   log_mapper_bucket_kb_ = kDefaultLogMapperBucketKb;
   log_mapper_io_buffer_mb_ = kDefaultLogMapperIoBufferMb;
@@ -33,6 +34,7 @@ SnapshotOptions::SnapshotOptions() {
   log_reducer_buffer_mb_ = kDefaultLogReducerBufferMb;
   log_reducer_dump_io_buffer_mb_ = kDefaultLogReducerDumpIoBufferMb;
   log_reducer_read_io_buffer_kb_ = kDefaultLogReducerReadIoBufferKb;
+  log_reducer_sort_threads_ = 1;
   snapshot_writer_page_pool_size_mb_ = kDefaultSnapshotWriterPagePoolSizeMb;
   snapshot_writer_intermediate_pool_size_mb_ = kDefaultSnapshotWriterIntermediatePoolSizeMb;
 }
@@ -53,6 +55,7 @@ std::string SnapshotOptions::construct_snapshot_file_path(int snapshot_id, int n
 ErrorStack SnapshotOptions::load(tinyxml2::XMLElement* element) {
   EXTERNALIZE_LOAD_ELEMENT(element, folder_path_pattern_);
   EXTERNALIZE_LOAD_ELEMENT(element, snapshot_trigger_page_pool_percent_);
+  EXTERNALIZE_LOAD_ELEMENT(element, evict_page_pool_percent_);
   EXTERNALIZE_LOAD_ELEMENT(element, snapshot_interval_milliseconds_);
   EXTERNALIZE_LOAD_ELEMENT(element, log_mapper_bucket_kb_);
   EXTERNALIZE_LOAD_ELEMENT(element, log_mapper_io_buffer_mb_);
@@ -60,6 +63,7 @@ ErrorStack SnapshotOptions::load(tinyxml2::XMLElement* element) {
   EXTERNALIZE_LOAD_ELEMENT(element, log_reducer_buffer_mb_);
   EXTERNALIZE_LOAD_ELEMENT(element, log_reducer_dump_io_buffer_mb_);
   EXTERNALIZE_LOAD_ELEMENT(element, log_reducer_read_io_buffer_kb_);
+  EXTERNALIZE_LOAD_ELEMENT(element, log_reducer_sort_threads_);
   EXTERNALIZE_LOAD_ELEMENT(element, snapshot_writer_page_pool_size_mb_);
   EXTERNALIZE_LOAD_ELEMENT(element, snapshot_writer_intermediate_pool_size_mb_);
   CHECK_ERROR(get_child_element(element, "SnapshotDeviceEmulationOptions", &emulation_))
@@ -77,6 +81,10 @@ ErrorStack SnapshotOptions::save(tinyxml2::XMLElement* element) const {
   EXTERNALIZE_SAVE_ELEMENT(element, snapshot_trigger_page_pool_percent_,
     "When the main page pool runs under this percent (roughly calculated) of free pages,\n"
     " snapshot manager starts snapshotting to drop volatile pages even before the interval.");
+  EXTERNALIZE_SAVE_ELEMENT(element, evict_page_pool_percent_,
+    "When the volatile page pool of some node runs under this percent of free pages,\n"
+    " snapshot manager evicts cold volatile pages whose content is already in the latest"
+    " snapshot. Only storages with non-zero evict_hotness_threshold_ are evicted. 0 disables.");
   EXTERNALIZE_SAVE_ELEMENT(element, snapshot_interval_milliseconds_,
     "Interval in milliseconds to take snapshots.");
   EXTERNALIZE_SAVE_ELEMENT(element, log_mapper_bucket_kb_,
@@ -95,6 +103,8 @@ ErrorStack SnapshotOptions::save(tinyxml2::XMLElement* element) const {
   EXTERNALIZE_SAVE_ELEMENT(element, log_reducer_read_io_buffer_kb_,
     "The size in KB of a buffer in reducer to read one temporary file. Note that the total"
     " memory consumption is this number times the number of temporary files. It's a merge-sort.");
+  EXTERNALIZE_SAVE_ELEMENT(element, log_reducer_sort_threads_,
+    "Number of threads each reducer uses to radix-sort log entries.");
   EXTERNALIZE_SAVE_ELEMENT(element, snapshot_writer_page_pool_size_mb_,
     "The size in MB of one snapshot writer, which holds data pages modified in the snapshot"
     " and them sequentially dumps them to a file for each storage.");
@@ -419,6 +419,10 @@ void SharedMemoryRepo::set_node_memory_anchors(
   total += align_4kb(sizeof(proc::LocalProcId) * options.proc_.max_proc_count_);
   put_node_memory_boundary(node, &total, "node_proc_name_sort_memory_boundary", reset_boundaries);
 
+  anchor.cache_manager_memory_ = reinterpret_cast<cache::CacheManagerControlBlock*>(base + total);
+  total += NodeMemoryAnchors::kCacheManagerMemorySize;
+  put_node_memory_boundary(node, &total, "node_cache_manager_memory_boundary", reset_boundaries);
+
   anchor.log_reducer_memory_ = reinterpret_cast<snapshot::LogReducerControlBlock*>(base + total);
   total += NodeMemoryAnchors::kLogReducerMemorySize;
   put_node_memory_boundary(node, &total, "node_log_reducer_memory_boundary", reset_boundaries);
@@ -510,6 +514,7 @@ uint64_t SharedMemoryRepo::calculate_node_memory_size(const EngineOptions& optio
   total += NodeMemoryAnchors::kProcManagerMemorySize + kBoundarySize;
   total += align_4kb(sizeof(proc::ProcAndName) * options.proc_.max_proc_count_) + kBoundarySize;
   total += align_4kb(sizeof(proc::LocalProcId) * options.proc_.max_proc_count_) + kBoundarySize;
+  total += NodeMemoryAnchors::kCacheManagerMemorySize + kBoundarySize;
   total += NodeMemoryAnchors::kLogReducerMemorySize + kBoundarySize;
   total += options.storage_.max_storages_ * 4096ULL + kBoundarySize;
 
@@ -74,7 +74,9 @@ ErrorStack ArrayComposer::compose(const Composer::ComposeArguments& args) {
     args.log_streams_,
     args.log_streams_count_,
     kMaxLevels,
-    args.work_memory_);
+    args.work_memory_,
+    snapshot::MergeSort::kDefaultChunkBatch,
+    engine_->get_options().snapshot_.log_reducer_sort_threads_);
   CHECK_ERROR(merge_sort.initialize());
 
   ArrayComposeContext context(
@@ -957,7 +959,7 @@ Composer::DropResult ArrayComposer::drop_volatiles(const Composer::DropVolatiles
   for (uint16_t i = 0; i < kInteriorFanout; ++i) {
     DualPagePointer& child_pointer = volatile_page->get_interior_record(i);
     if (!child_pointer.volatile_pointer_.is_null()) {
-      ASSERT_ND(child_pointer.snapshot_pointer_ != 0);
+      ASSERT_ND(args.evicting_ || child_pointer.snapshot_pointer_ != 0);
       uint16_t partition = extract_numa_node_from_snapshot_pointer(child_pointer.snapshot_pointer_);
       if (!args.partitioned_drop_ || partition == args.my_partition_) {
         result.combine(drop_volatiles_recurse(args, &child_pointer));
@@ -1067,9 +1069,12 @@ Composer::DropResult ArrayComposer::drop_volatiles_intermediate(
   }
 
   if (result.dropped_all_) {
-    if (is_to_keep_volatile(volatile_page->get_level())) {
+    if (!args.evicting_ && is_to_keep_volatile(volatile_page->get_level())) {
       DVLOG(2) << "Exempted";
       result.dropped_all_ = false;
+    } else if (args.evicting_ && pointer->snapshot_pointer_ == 0) {
+      DVLOG(1) << "Can't evict a page that has never been snapshotted";
+      result.dropped_all_ = false;
     } else {
       args.drop(engine_, pointer->volatile_pointer_);
       pointer->volatile_pointer_.clear();
@@ -1088,7 +1093,16 @@ inline Composer::DropResult ArrayComposer::drop_volatiles_leaf(
   ASSERT_ND(!volatile_page->header().snapshot_);
   ASSERT_ND(volatile_page->is_leaf());
   Composer::DropResult result(args);
-  if (is_to_keep_volatile(volatile_page->get_level())) {
+  if (args.evicting_) {
+    // Array pages have fixed boundaries, so the snapshot page is never stale as far as
+    // the records are not newer than the latest snapshot.
+    const uint32_t threshold
+      = storage_.get_array_metadata()->snapshot_thresholds_.evict_hotness_threshold_;
+    if (pointer->snapshot_pointer_ == 0 || volatile_page->header().hotness_.value_ >= threshold) {
+      result.dropped_all_ = false;
+      return result;
+    }
+  } else if (is_to_keep_volatile(volatile_page->get_level())) {
     DVLOG(2) << "Exempted";
     result.dropped_all_ = false;
     return result;
@@ -25,6 +25,7 @@
 
 #include "foedus/engine.hpp"
 #include "foedus/engine_options.hpp"
+#include "foedus/assorted/radix_sort.hpp"
 #include "foedus/debugging/stop_watch.hpp"
 #include "foedus/log/common_log_types.hpp"
 #include "foedus/memory/aligned_memory.hpp"
@@ -318,7 +319,8 @@ void ArrayPartitioner::sort_batch(const Partitioner::SortBatchArguments& args) c
   // we so far sort them in one path.
   // to save memory, we could do multi-path merge-sort.
   // however, in reality each log has many bytes, so log_count is not that big.
-  args.work_memory_->assure_capacity(sizeof(SortEntry) * args.logs_count_);
+  // the latter half is the scratch area for radix sort
+  args.work_memory_->assure_capacity(sizeof(SortEntry) * args.logs_count_ * 2U);
 
   debugging::StopWatch stop_watch_entire;
 
@@ -328,10 +330,14 @@ void ArrayPartitioner::sort_batch(const Partitioner::SortBatchArguments& args) c
 
   debugging::StopWatch stop_watch;
   // Gave up non-gcc support because of aarch64 support. yes, we can also assume __uint128_t.
-  // CPU profile of partition_array_perf: 50% (introsort_loop) + 7% (other inlined).
-  std::sort(
+  // std::sort (introsort_loop) used to be 50% of CPU profile of partition_array_perf.
+  // Radix sort on the 16 bytes gives exactly the same order and skips bytes that don't vary.
+  assorted::radix_sort_uint128(
     reinterpret_cast<__uint128_t*>(entries),
-    reinterpret_cast<__uint128_t*>(entries + args.logs_count_));
+    reinterpret_cast<__uint128_t*>(entries + args.logs_count_),
+    args.logs_count_,
+    0,
+    engine_->get_options().snapshot_.log_reducer_sort_threads_);
   stop_watch.stop();
   VLOG(0) << "Sorted " << args.logs_count_ << " log entries in " << stop_watch.elapsed_ms() << "ms";
 
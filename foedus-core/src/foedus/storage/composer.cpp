@@ -46,6 +46,7 @@ std::ostream& operator<<(std::ostream& o, const Composer& v) {
 std::ostream& operator<<(std::ostream& o, const Composer::DropResult& v) {
   o << "<DropResult>"
     << "<max_observed_>" << v.max_observed_ << "</max_observed_>"
+    << "<max_record_epoch_>" << v.max_record_epoch_ << "</max_record_epoch_>"
     << "<dropped_all_>" << v.dropped_all_ << "</dropped_all_>"
     << "</DropResult>";
   return o;
@@ -137,5 +138,21 @@ void Composer::DropVolatilesArguments::drop(
   ++(*dropped_count_);
 }
 
+bool Composer::DropVolatilesArguments::is_covered_by_snapshot(
+  SnapshotPagePointer pointer,
+  Epoch max_record_epoch) const {
+  ASSERT_ND(evicting_);
+  if (pointer == 0) {
+    return false;
+  }
+  snapshot::SnapshotId snapshot_id = extract_snapshot_id_from_snapshot_pointer(pointer);
+  if (snapshot_id == snapshot_.id_ || !max_record_epoch.is_valid()) {
+    return true;
+  }
+  ASSERT_ND(snapshot_epochs_);
+  Epoch valid_until(snapshot_epochs_[snapshot_id]);
+  return valid_until.is_valid() && max_record_epoch <= valid_until;
+}
+
 }  // namespace storage
 }  // namespace foedus
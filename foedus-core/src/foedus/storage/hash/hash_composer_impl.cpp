@@ -105,7 +105,9 @@ ErrorStack HashComposer::compose(const Composer::ComposeArguments& args) {
     args.log_streams_,
     args.log_streams_count_,
     kHashMaxLevels,
-    args.work_memory_);
+    args.work_memory_,
+    snapshot::MergeSort::kDefaultChunkBatch,
+    engine_->get_options().snapshot_.log_reducer_sort_threads_);
   CHECK_ERROR(merge_sort.initialize());
 
   HashComposeContext context(
@@ -1209,7 +1211,8 @@ void HashComposer::drop_volatiles_child(
   } else {
     if (can_drop_volatile_bin(
       child_pointer->volatile_pointer_,
-      args.snapshot_.valid_until_epoch_)) {
+      args.snapshot_.valid_until_epoch_)
+      && (!args.evicting_ || is_cold_bin(child_pointer->volatile_pointer_))) {
       drop_volatile_entire_bin(args, child_pointer);
     } else {
       result->dropped_all_ = false;
@@ -1300,7 +1303,7 @@ inline Composer::DropResult HashComposer::drop_volatiles_recurse(
     }
   }
   if (result.dropped_all_) {
-    if (is_to_keep_volatile(page->get_level())) {
+    if (!args.evicting_ && is_to_keep_volatile(page->get_level())) {
       DVLOG(2) << "Exempted";
       result.dropped_all_ = false;
     } else {
@@ -1329,6 +1332,18 @@ bool HashComposer::can_drop_volatile_bin(VolatilePagePointer head, Epoch valid_u
   return true;
 }
 
+bool HashComposer::is_cold_bin(VolatilePagePointer head) const {
+  const uint32_t threshold
+    = storage_.get_hash_metadata()->snapshot_thresholds_.evict_hotness_threshold_;
+  for (HashDataPage* cur = resolve_data(head);
+        cur;
+        cur = resolve_data(cur->next_page().volatile_pointer_)) {
+    if (cur->header().hotness_.value_ >= threshold) {
+      return false;
+    }
+  }
+  return true;
+}
 
 inline bool HashComposer::is_to_keep_volatile(uint16_t level) {
   /*
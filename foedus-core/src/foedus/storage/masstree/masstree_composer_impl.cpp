@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "foedus/engine.hpp"
+#include "foedus/engine_options.hpp"
 #include "foedus/cache/snapshot_file_set.hpp"
 #include "foedus/debugging/stop_watch.hpp"
 #include "foedus/fs/direct_io_file.hpp"
@@ -86,7 +87,9 @@ ErrorStack MasstreeComposer::compose(const Composer::ComposeArguments& args) {
     args.log_streams_,
     args.log_streams_count_,
     MasstreeComposeContext::kMaxLevels,
-    args.work_memory_);
+    args.work_memory_,
+    snapshot::MergeSort::kDefaultChunkBatch,
+    engine_->get_options().snapshot_.log_reducer_sort_threads_);
   CHECK_ERROR(merge_sort.initialize());
 
   MasstreeComposeContext context(engine_, &merge_sort, args);
@@ -692,7 +695,7 @@ ErrorStack MasstreeComposeContext::execute_same_key_group(uint32_t from, uint32_
     // Also, we look for a chance to ignore redundant overwrites.
     // If next overwrite log covers the same or more data range, we can skip the log.
     // Ideally, we should have removed such logs back in mappers.
-    if (i < to) {
+    if (i + 1U < to) {
       const MasstreeOverwriteLogType* next =
         reinterpret_cast<const MasstreeOverwriteLogType*>(
           merge_sort_->resolve_sort_position(i + 1U));
@@ -1308,7 +1311,7 @@ ErrorStack MasstreeComposeContext::open_next_level(
     MasstreeBorderPage* target_casted = as_border(target);
     ASSERT_ND(copy_count <= key_count);
     target_casted->set_key_count(copy_count);
-    level->next_original_ = copy_count + 1U;
+    level->next_original_ = copy_count;  // the first record we haven't copied
     if (level->next_original_ >= key_count) {
       level->set_no_more_next_original();
     } else {
@@ -2573,6 +2576,14 @@ Composer::DropResult MasstreeComposer::drop_volatiles(
     return result;
   }
 
+  if (!args.partitioned_drop_) {
+    for (MasstreeIntermediatePointerIterator it(volatile_page); it.is_valid(); it.next()) {
+      DualPagePointer* pointer = &volatile_page->get_minipage(it.index_).pointers_[it.index_mini_];
+      result.combine(drop_volatiles_recurse(args, pointer));
+    }
+    return result;
+  }
+
   // Unlike array-storage, each thread decides partititions to follow a bit differently
   // because the snapshot pointer might be not installed.
   // We check the partitioning assignment.
@@ -2585,10 +2596,6 @@ Composer::DropResult MasstreeComposer::drop_volatiles(
   uint16_t cur = 0;
   for (MasstreeIntermediatePointerIterator it(volatile_page); it.is_valid(); it.next()) {
     DualPagePointer* pointer = &volatile_page->get_minipage(it.index_).pointers_[it.index_mini_];
-    if (!args.partitioned_drop_) {
-      result.combine(drop_volatiles_recurse(args, pointer));
-      continue;
-    }
     // the page boundaries as of partitioning might be different from the volatile page's,
     // but at least it's more coarse. Each pointer belongs to just one partition.
     // same trick as install_pointers.
@@ -2735,9 +2742,17 @@ inline Composer::DropResult MasstreeComposer::drop_volatiles_recurse(
   }
   ASSERT_ND(result.max_observed_ == args.snapshot_.valid_until_epoch_);
   ASSERT_ND(result.dropped_all_);
-  bool updated_pointer = is_updated_pointer(args, pointer->snapshot_pointer_);
+  bool updated_pointer;
+  if (args.evicting_) {
+    // the pointer might have been installed by an older snapshot.
+    updated_pointer = args.is_covered_by_snapshot(
+      pointer->snapshot_pointer_,
+      result.max_record_epoch_);
+  } else {
+    updated_pointer = is_updated_pointer(args, pointer->snapshot_pointer_);
+  }
   if (updated_pointer) {
-    if (is_to_keep_volatile(page->get_layer(), page->get_btree_level())) {
+    if (!args.evicting_ && is_to_keep_volatile(page->get_layer(), page->get_btree_level())) {
       DVLOG(2) << "Exempted";
       result.dropped_all_ = false;  // max_observed is satisfactory, but we chose to not drop.
     } else {
@@ -2826,6 +2841,12 @@ inline Composer::DropResult MasstreeComposer::drop_volatiles_border(
       result.on_rec_observed(epoch);
     }
   }
+  if (args.evicting_
+    && page->header().hotness_.value_
+      >= storage_.get_masstree_metadata()->snapshot_thresholds_.evict_hotness_threshold_) {
+    DVLOG(2) << "Not cold enough to evict";
+    result.dropped_all_ = false;
+  }
   return result;
 }
 inline bool MasstreeComposer::is_updated_pointer(
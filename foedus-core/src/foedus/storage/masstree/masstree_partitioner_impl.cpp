@@ -28,8 +28,11 @@
 #include <utility>
 #include <vector>
 
+#include "foedus/engine.hpp"
+#include "foedus/engine_options.hpp"
 #include "foedus/assorted/assorted_func.hpp"
 #include "foedus/assorted/endianness.hpp"
+#include "foedus/assorted/radix_sort.hpp"
 #include "foedus/debugging/rdtsc_watch.hpp"
 #include "foedus/debugging/stop_watch.hpp"
 #include "foedus/memory/engine_memory.hpp"
@@ -103,8 +106,8 @@ ErrorStack MasstreePartitioner::design_partition(
     if (snapshot_page_id == 0) {
       CHECK_ERROR(design_partition_first(vol));
     } else {
-      // So far same assignment as previous snapshot.
-      // TODO(Hideaki) check current volatile pages to change the assignments.
+      // Same partition keys as previous snapshot, which the composers rely on.
+      // However, the assigned nodes follow the current volatile pages.
       for (MasstreeIntermediatePointerIterator it(snp); it.is_valid(); it.next()) {
         data_->low_keys_[data_->partition_count_] = it.get_low_key();
         SnapshotPagePointer pointer = it.get_pointer().snapshot_pointer_;
@@ -112,6 +115,7 @@ ErrorStack MasstreePartitioner::design_partition(
         data_->partitions_[data_->partition_count_] = assignment;
         ++data_->partition_count_;
       }
+      CHECK_ERROR(design_partition_adaptive(vol));
     }
   }
 
@@ -128,7 +132,8 @@ void design_partition_first_parallel_recurse(
   OwnerSamples* result,
   assorted::UniformRandom* unirand) {
   uint32_t node = page->header().stat_last_updater_node_;
-  result->increment(node, subtree_id);
+  // a hot page counts more. the counter is exponential, so its value is roughly log(accesses).
+  result->increment(node, subtree_id, 1U + page->header().hotness_.value_);
   // we don't care foster twins. this is just for sampling.
   if (!page->is_border()) {
     const auto* casted = reinterpret_cast<const MasstreeIntermediatePage*>(page);
@@ -213,6 +218,101 @@ ErrorStack MasstreePartitioner::design_partition_first(const MasstreeIntermediat
   return kRetOk;
 }
 
+ErrorStack MasstreePartitioner::design_partition_adaptive(const MasstreeIntermediatePage* root) {
+  // Take samples of current volatile pages in the same way as design_partition_first(), but
+  // the subtrees are now the volatile root's children, which might have been split since
+  // the previous snapshot. We then map them to the partitions by key ranges.
+  std::vector<VolatilePagePointer> pointers;
+  std::vector<KeySlice> low_keys;
+  std::vector<KeySlice> high_keys;
+  pointers.reserve(kMaxIntermediatePointers);
+  for (MasstreeIntermediatePointerIterator it(root); it.is_valid(); it.next()) {
+    const DualPagePointer& pointer = it.get_pointer();
+    if (pointer.volatile_pointer_.is_null()) {
+      continue;  // dropped by previous snapshot, so no one has been accessing it.
+    }
+    pointers.push_back(pointer.volatile_pointer_);
+    low_keys.push_back(it.get_low_key());
+    high_keys.push_back(it.get_high_key());
+  }
+  if (pointers.empty()) {
+    LOG(INFO) << "Masstree-" << id_ << " has no volatile pages. Keeps the previous assignment";
+    return kRetOk;
+  }
+
+  const uint32_t subtrees = pointers.size();
+  OwnerSamples samples(engine_->get_soc_count(), subtrees);
+  std::vector< std::thread > threads;
+  threads.reserve(subtrees);
+  for (uint32_t subtree_id = 0; subtree_id < subtrees; ++subtree_id) {
+    threads.emplace_back(
+      design_partition_first_parallel,
+      engine_,
+      pointers[subtree_id],
+      subtree_id,
+      &samples);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // A volatile subtree might span more than one partition. In that case it counts for all of
+  // them, which is fine as a statistics.
+  const uint32_t nodes = engine_->get_soc_count();
+  uint64_t remote_before = 0;
+  uint64_t remote_after = 0;
+  uint64_t total = 0;
+  uint16_t changed = 0;
+  std::vector<uint64_t> counts(nodes);
+  for (uint16_t i = 0; i < data_->partition_count_; ++i) {
+    KeySlice partition_low = data_->low_keys_[i];
+    KeySlice partition_high = (i + 1U == data_->partition_count_)
+      ? kSupremumSlice
+      : data_->low_keys_[i + 1U];
+    std::memset(&counts[0], 0, sizeof(uint64_t) * nodes);
+    uint64_t partition_total = 0;
+    for (uint32_t subtree_id = 0; subtree_id < subtrees; ++subtree_id) {
+      if (low_keys[subtree_id] >= partition_high || high_keys[subtree_id] <= partition_low) {
+        continue;
+      }
+      for (uint32_t node = 0; node < nodes; ++node) {
+        counts[node] += samples.at(node, subtree_id);
+        partition_total += samples.at(node, subtree_id);
+      }
+    }
+    if (partition_total == 0) {
+      continue;  // no volatile page. keep the previous assignment
+    }
+
+    // Move only when another node has strictly more samples so that a tie doesn't cause
+    // the partition to bounce between nodes in every snapshot.
+    const uint16_t previous = data_->partitions_[i];
+    uint16_t best = previous;
+    for (uint16_t node = 0; node < nodes; ++node) {
+      if (counts[node] > counts[best]) {
+        best = node;
+      }
+    }
+    total += partition_total;
+    remote_before += partition_total - counts[previous];
+    remote_after += partition_total - counts[best];
+    if (best != previous) {
+      VLOG(0) << "Masstree-" << id_ << " partition-" << i << " moves from node-" << previous
+        << " to node-" << best;
+      data_->partitions_[i] = best;
+      ++changed;
+    }
+  }
+
+  // the ratio of sampled volatile pages whose node differs from the partition's node.
+  // this approximates how many reads to the new snapshot pages will be remote.
+  LOG(INFO) << "Masstree-" << id_ << " re-assigned " << changed << " out of "
+    << data_->partition_count_ << " partitions based on " << total << " samples. Remote ratio: "
+    << (total == 0 ? 0.0 : static_cast<double>(remote_before) / total) << " -> "
+    << (total == 0 ? 0.0 : static_cast<double>(remote_after) / total);
+  return kRetOk;
+}
+
 void OwnerSamples::assign_owners() {
   // so far simply the node that has majority. but we might want to balance out
   for (uint32_t subtree_id = 0; subtree_id < subtrees_; ++subtree_id) {
@@ -466,15 +566,28 @@ void prepare_sort_entries(const Partitioner::SortBatchArguments& args, SortEntry
 void MasstreePartitioner::sort_batch_8bytes(const Partitioner::SortBatchArguments& args) const {
   ASSERT_ND(args.shortest_key_length_ == sizeof(KeySlice));
   ASSERT_ND(args.longest_key_length_ == sizeof(KeySlice));
-  args.work_memory_->assure_capacity(sizeof(SortEntry) * args.logs_count_);
+  // the latter half is the scratch area for radix sort
+  args.work_memory_->assure_capacity(sizeof(SortEntry) * args.logs_count_ * 2U);
 
   debugging::StopWatch stop_watch_entire;
   ASSERT_ND(sizeof(SortEntry) == 24U);
   SortEntry* entries = reinterpret_cast<SortEntry*>(args.work_memory_->get_block());
   prepare_sort_entries(args, entries);
 
-  // CPU profile of partition_masstree_perf: 80% (introsort_loop) + 9% (other inlined parts).
-  std::sort(entries, entries + args.logs_count_);
+  // std::sort (introsort_loop) used to be 80% of CPU profile of partition_masstree_perf.
+  // Radix sort in the order of operator<: position_, combined_epoch_, then first_slice_.
+  const uint8_t kByteOrder[] = {
+    16, 17, 18, 19,
+    8, 9, 10, 11, 12, 13, 14, 15,
+    0, 1, 2, 3, 4, 5, 6, 7};
+  assorted::radix_sort(
+    entries,
+    entries + args.logs_count_,
+    args.logs_count_,
+    sizeof(SortEntry),
+    kByteOrder,
+    sizeof(kByteOrder),
+    engine_->get_options().snapshot_.log_reducer_sort_threads_);
 
   retrieve_positions(args.logs_count_, entries, args.output_buffer_);
   *args.written_count_ = args.logs_count_;
@@ -648,6 +648,10 @@ ErrorCode MasstreeStoragePimpl::register_record_write_log(
   log::RecordLogType* log_entry) {
   // If we have taken readset in locate_record, add as a related write set
   MasstreeBorderPage* border = location.page_;
+  // loosely maintained stat for partitioner. check first not to needlessly dirty the cacheline
+  if (border->header().stat_last_updater_node_ != context->get_numa_node()) {
+    border->header().stat_last_updater_node_ = context->get_numa_node();
+  }
   auto* tid = border->get_owner_id(location.index_);
   char* record = border->get_record(location.index_);
   xct::Xct* cur_xct = &context->get_current_xct();
@@ -60,6 +60,12 @@ ErrorStack MetadataSerializer::load_base(tinyxml2::XMLElement* element) {
     element,
     "snapshot_keep_threshold_",
     &data_->snapshot_thresholds_.snapshot_keep_threshold_));
+  CHECK_ERROR(get_element(
+    element,
+    "evict_hotness_threshold_",
+    &data_->snapshot_thresholds_.evict_hotness_threshold_,
+    true,
+    0U));
   return kRetOk;
 }
 
@@ -78,6 +84,11 @@ ErrorStack MetadataSerializer::save_base(tinyxml2::XMLElement* element) const {
     "snapshot_keep_threshold_",
     "",
     data_->snapshot_thresholds_.snapshot_keep_threshold_));
+  CHECK_ERROR(add_element(
+    element,
+    "evict_hotness_threshold_",
+    "",
+    data_->snapshot_thresholds_.evict_hotness_threshold_));
   return kRetOk;
 }
 
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include "foedus/thread/pipelined_session.hpp"
+
+#include <glog/logging.h>
+
+#include <cstring>
+#include <ostream>
+
+#include "foedus/assert_nd.hpp"
+#include "foedus/compiler.hpp"
+#include "foedus/engine.hpp"
+#include "foedus/assorted/atomic_fences.hpp"
+#include "foedus/proc/proc_manager.hpp"
+#include "foedus/thread/thread_pimpl.hpp"
+#include "foedus/thread/thread_ref.hpp"
+
+namespace foedus {
+namespace thread {
+
+uint32_t PipelinedSession::get_capacity() { return TaskQueue::kCapacity; }
+uint32_t PipelinedSession::get_slot_size() { return TaskQueue::kSlotSize; }
+
+ErrorStack PipelinedSession::resolve_proc(
+  const proc::ProcName& name,
+  proc::LocalProcId* out) const {
+  ASSERT_ND(is_valid());
+  ThreadRef* thread = session_.thread_;
+  return thread->get_engine()->get_proc_manager()->get_local_proc_id(
+    thread->get_numa_node(),
+    name,
+    out);
+}
+
+bool PipelinedSession::submit(proc::LocalProcId proc_id, const void* input, uint32_t input_len) {
+  return submit_batch(1U, &proc_id, &input, &input_len) == 1U;
+}
+
+uint32_t PipelinedSession::submit_batch(
+  uint32_t count,
+  const proc::LocalProcId* proc_ids,
+  const void* const* inputs,
+  const uint32_t* input_lens) {
+  ASSERT_ND(is_valid());
+  ThreadRef* thread = session_.thread_;
+  TaskQueue* queue = &thread->get_control_block()->task_queue_;
+  char* const input_base = reinterpret_cast<char*>(thread->get_task_input_memory());
+  const uint32_t free_slots = TaskQueue::kCapacity - get_in_flight();
+  uint32_t i;
+  for (i = 0; i < count && i < free_slots; ++i) {
+    if (UNLIKELY(input_lens[i] > TaskQueue::kSlotSize)) {
+      LOG(WARNING) << "Input of a pipelined task is too large: " << input_lens[i];
+      break;
+    }
+    const uint32_t index = (submitted_ + i) % TaskQueue::kCapacity;
+    TaskQueueEntry* entry = queue->entries_ + index;
+    entry->proc_id_ = proc_ids[i];
+    entry->input_len_ = input_lens[i];
+    if (input_lens[i] > 0) {
+      std::memcpy(input_base + index * TaskQueue::kSlotSize, inputs[i], input_lens[i]);
+    }
+  }
+  if (i > 0) {
+    // One release-store publishes all of them, and the worker needs only one wakeup.
+    submitted_ += i;
+    assorted::atomic_store_release<uint64_t>(&queue->submitted_, submitted_);
+    thread->get_control_block()->wakeup_cond_.signal();
+  }
+  return i;
+}
+
+uint32_t PipelinedSession::poll_completions() const {
+  if (!is_valid()) {
+    return 0;
+  }
+  const TaskQueue* queue = &session_.thread_->get_control_block()->task_queue_;
+  uint64_t completed = assorted::atomic_load_acquire<uint64_t>(&queue->completed_);
+  ASSERT_ND(completed >= reaped_);
+  return static_cast<uint32_t>(completed - reaped_);
+}
+
+bool PipelinedSession::wait_for_completion(int64_t timeout_microsec) const {
+  if (!is_valid() || get_in_flight() == 0) {
+    return false;
+  } else if (poll_completions() > 0) {
+    return true;
+  } else if (timeout_microsec == 0) {
+    return false;
+  }
+
+  ThreadControlBlock* block = session_.thread_->get_control_block();
+  // Same as ImpersonateSession::wait(), we wake up periodically just in case.
+  const uint64_t kIntervalMicrosec = 100000ULL;
+  uint64_t remaining = timeout_microsec;
+  while (poll_completions() == 0) {
+    uint64_t demand = block->task_complete_cond_.acquire_ticket();
+    if (poll_completions() > 0) {
+      break;
+    }
+    if (timeout_microsec < 0) {
+      block->task_complete_cond_.timedwait(demand, kIntervalMicrosec);
+    } else {
+      // timeout is a hint rather than a deadline, like ImpersonateSession::wait_for()
+      block->task_complete_cond_.timedwait(demand, remaining);
+      break;
+    }
+  }
+  return poll_completions() > 0;
+}
+
+bool PipelinedSession::reap(PipelinedResult* out) {
+  if (get_in_flight() == 0) {
+    return false;
+  }
+  wait_for_completion();
+  ThreadRef* thread = session_.thread_;
+  const TaskQueue* queue = &thread->get_control_block()->task_queue_;
+  const uint32_t index = reaped_ % TaskQueue::kCapacity;
+  const TaskQueueEntry* entry = queue->entries_ + index;
+  const char* output_base = reinterpret_cast<const char*>(thread->get_task_output_memory());
+  out->result_ = entry->result_;
+  out->output_len_ = entry->output_len_;
+  out->output_ = output_base + index * TaskQueue::kSlotSize;
+  ++reaped_;
+  return true;
+}
+
+void PipelinedSession::release() {
+  if (!is_valid()) {
+    return;
+  }
+
+  TaskQueue* queue = &session_.thread_->get_control_block()->task_queue_;
+  assorted::atomic_store_release<bool>(&queue->close_requested_, true);
+  session_.thread_->get_control_block()->wakeup_cond_.signal();
+  // This waits until the worker drains the queue and leaves it.
+  session_.release();
+  submitted_ = 0;
+  reaped_ = 0;
+}
+
+std::ostream& operator<<(std::ostream& o, const PipelinedSession& v) {
+  o << "PipelinedSession: valid=" << v.is_valid();
+  if (v.is_valid()) {
+    o << ", thread_id=" << v.session_.thread_->get_thread_id()
+      << ", submitted=" << v.submitted_ << ", reaped=" << v.reaped_;
+  }
+  return o;
+}
+
+}  // namespace thread
+}  // namespace foedus
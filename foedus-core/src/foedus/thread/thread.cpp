@@ -67,9 +67,14 @@ uint64_t Thread::get_snapshot_cache_misses() const {
   return pimpl_->control_block_->stat_snapshot_cache_misses_;
 }
 
+uint64_t Thread::get_snapshot_cache_remote_hits() const {
+  return pimpl_->control_block_->stat_snapshot_cache_remote_hits_;
+}
+
 void Thread::reset_snapshot_cache_counts() const {
   pimpl_->control_block_->stat_snapshot_cache_hits_ = 0;
   pimpl_->control_block_->stat_snapshot_cache_misses_ = 0;
+  pimpl_->control_block_->stat_snapshot_cache_remote_hits_ = 0;
 }
 
 xct::Xct&   Thread::get_current_xct()   { return pimpl_->current_xct_; }
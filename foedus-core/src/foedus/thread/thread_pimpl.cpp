@@ -19,9 +19,11 @@
 
 #include <pthread.h>
 #include <sched.h>
+#include <unistd.h>
 #include <glog/logging.h>
 
 #include <atomic>
+#include <cstring>
 #include <future>
 #include <mutex>
 #include <thread>
@@ -32,6 +34,7 @@
 #include "foedus/error_stack_batch.hpp"
 #include "foedus/assorted/atomic_fences.hpp"
 #include "foedus/cache/cache_hashtable.hpp"
+#include "foedus/cache/cache_manager_pimpl.hpp"
 #include "foedus/log/thread_log_buffer.hpp"
 #include "foedus/memory/engine_memory.hpp"
 #include "foedus/memory/numa_core_memory.hpp"
@@ -104,6 +107,16 @@ ErrorStack ThreadPimpl::initialize_once() {
     snapshot_cache_hashtable_ = nullptr;
   }
   snapshot_page_pool_ = node_memory_->get_snapshot_pool();
+  remote_snapshot_caches_.clear();
+  if (snapshot_cache_hashtable_ && engine_->get_options().cache_.snapshot_cache_remote_lookup_) {
+    soc::SharedMemoryRepo* memory_repo = engine_->get_soc_manager()->get_shared_memory_repo();
+    uint16_t nodes = engine_->get_soc_count();
+    for (uint16_t i = 1; i < nodes; ++i) {
+      uint16_t node = (numa_node_ + i) % nodes;
+      remote_snapshot_caches_.push_back(
+        memory_repo->get_node_memory_anchors(node)->cache_manager_memory_);
+    }
+  }
   current_xct_.initialize(
     core_memory_,
     &control_block_->mcs_block_current_,
@@ -151,6 +164,7 @@ ErrorStack ThreadPimpl::uninitialize_once() {
   core_memory_ = nullptr;
   node_memory_ = nullptr;
   snapshot_cache_hashtable_ = nullptr;
+  remote_snapshot_caches_.clear();
   control_block_->uninitialize();
   return SUMMARIZE_ERROR_BATCH(batch);
 }
@@ -196,28 +210,31 @@ void ThreadPimpl::handle_tasks() {
       current_xct_.set_default_rll_threshold_for_this_xct(
         engine_->get_options().xct_.hot_threshold_for_retrospective_lock_list_);
 
-      const proc::ProcName& proc_name = control_block_->proc_name_;
-      VLOG(0) << "Thread-" << id_ << " retrieved a task: " << proc_name;
-      proc::Proc proc = nullptr;
-      ErrorStack result = engine_->get_proc_manager()->get_proc(proc_name, &proc);
-      if (result.is_error()) {
-        // control_block_->proc_result_
-        LOG(ERROR) << "Thread-" << id_ << " couldn't find procedure: " << proc_name;
+      ErrorStack result;
+      if (control_block_->task_queue_.active_) {
+        VLOG(0) << "Thread-" << id_ << " started a pipelined session";
+        handle_pipelined_tasks();
       } else {
-        uint32_t output_used = 0;
-        proc::ProcArguments args = {
-          engine_,
-          holder_,
-          task_input_memory_,
-          control_block_->input_len_,
-          task_output_memory_,
-          soc::ThreadMemoryAnchors::kTaskOutputMemorySize,
-          &output_used,
-        };
-        result = proc(args);
-        VLOG(0) << "Thread-" << id_ << " run(task) returned. result =" << result
-          << ", output_used=" << output_used;
-        control_block_->output_len_ = output_used;
+        const proc::ProcName& proc_name = control_block_->proc_name_;
+        VLOG(0) << "Thread-" << id_ << " retrieved a task: " << proc_name;
+        proc::Proc proc = nullptr;
+        result = engine_->get_proc_manager()->get_proc(proc_name, &proc);
+        if (result.is_error()) {
+          // control_block_->proc_result_
+          LOG(ERROR) << "Thread-" << id_ << " couldn't find procedure: " << proc_name;
+        } else {
+          uint32_t output_used = 0;
+          result = invoke_proc(
+            proc,
+            task_input_memory_,
+            control_block_->input_len_,
+            task_output_memory_,
+            soc::ThreadMemoryAnchors::kTaskOutputMemorySize,
+            &output_used);
+          VLOG(0) << "Thread-" << id_ << " run(task) returned. result =" << result
+            << ", output_used=" << output_used;
+          control_block_->output_len_ = output_used;
+        }
       }
       if (result.is_error()) {
         control_block_->proc_result_.from_error_stack(result);
@@ -236,6 +253,82 @@ void ThreadPimpl::handle_tasks() {
   control_block_->status_ = kTerminated;
   LOG(INFO) << "Thread-" << id_ << " exits";
 }
+
+void ThreadPimpl::handle_pipelined_tasks() {
+  TaskQueue* queue = &control_block_->task_queue_;
+  char* const input_base = reinterpret_cast<char*>(task_input_memory_);
+  char* const output_base = reinterpret_cast<char*>(task_output_memory_);
+  proc::ProcManager* proc_manager = engine_->get_proc_manager();
+  const uint32_t kIdleSpins = 1U << 10;
+  uint32_t idle_spins = 0;
+  while (!is_stop_requested()) {
+    const uint64_t completed = queue->completed_;
+    const uint64_t submitted = assorted::atomic_load_acquire<uint64_t>(&queue->submitted_);
+    ASSERT_ND(completed <= submitted);
+    ASSERT_ND(submitted - completed <= TaskQueue::kCapacity);
+    if (completed == submitted) {
+      if (assorted::atomic_load_acquire<bool>(&queue->close_requested_)) {
+        break;
+      } else if (++idle_spins < kIdleSpins) {
+        assorted::spinlock_yield();
+        continue;
+      }
+      // The client seems not submitting anything for a while. Sleep until it does.
+      uint64_t demand = control_block_->wakeup_cond_.acquire_ticket();
+      if (assorted::atomic_load_acquire<uint64_t>(&queue->submitted_) == submitted
+        && !assorted::atomic_load_acquire<bool>(&queue->close_requested_)
+        && !is_stop_requested()) {
+        control_block_->wakeup_cond_.timedwait(demand, 100000ULL, 1U << 16, 1U << 13);
+      }
+      idle_spins = 0;
+      continue;
+    }
+
+    idle_spins = 0;
+    const uint32_t index = completed % TaskQueue::kCapacity;
+    TaskQueueEntry* entry = queue->entries_ + index;
+    proc::Proc proc = nullptr;
+    ErrorStack result = proc_manager->get_proc_by_local_id(entry->proc_id_, &proc);
+    uint32_t output_used = 0;
+    if (!result.is_error()) {
+      result = invoke_proc(
+        proc,
+        input_base + index * TaskQueue::kSlotSize,
+        entry->input_len_,
+        output_base + index * TaskQueue::kSlotSize,
+        TaskQueue::kSlotSize,
+        &output_used);
+    }
+    entry->output_len_ = output_used;
+    entry->result_ = result.get_error_code();
+    assorted::atomic_store_release<uint64_t>(&queue->completed_, completed + 1U);
+    // Wakeup the client if it's waiting. This is just an atomic increment.
+    control_block_->task_complete_cond_.signal();
+  }
+  queue->active_ = false;
+  VLOG(0) << "Thread-" << id_ << " finished a pipelined session. " << queue->completed_
+    << " tasks completed";
+}
+
+ErrorStack ThreadPimpl::invoke_proc(
+  proc::Proc proc,
+  const void* input,
+  uint32_t input_len,
+  void* output,
+  uint32_t output_capacity,
+  uint32_t* output_used) {
+  *output_used = 0;
+  proc::ProcArguments args = {
+    engine_,
+    holder_,
+    input,
+    input_len,
+    output,
+    output_capacity,
+    output_used,
+  };
+  return proc(args);
+}
 void ThreadPimpl::set_thread_schedule() {
   // this code totally assumes pthread. maybe ifdef to handle Windows.. later!
   SPINLOCK_WHILE(raw_thread_set_ == false) {
@@ -309,6 +402,7 @@ ErrorCode ThreadPimpl::install_a_volatile_page(
   ASSERT_ND(page->get_header().snapshot_);
   page->get_header().snapshot_ = false;  // now it's volatile
   page->get_header().page_id_ = volatile_pointer.word;  // and correct page ID
+  page->get_header().stat_last_updater_node_ = volatile_pointer.get_numa_node();
 
   *installed_page = place_a_new_volatile_page(offset, pointer);
   return kErrorCodeOk;
@@ -657,15 +751,11 @@ ErrorCode ThreadPimpl::find_or_read_a_snapshot_page(
       if (offset != 0) {
         DVLOG(0) << "Interesting, this race is rare, but possible. offset=" << offset;
       }
-      CHECK_ERROR_CODE(on_snapshot_cache_miss(page_id, &offset));
-      ASSERT_ND(offset != 0);
-      CHECK_ERROR_CODE(snapshot_cache_hashtable_->install(page_id, offset));
-      ++control_block_->stat_snapshot_cache_misses_;
+      CHECK_ERROR_CODE(on_snapshot_cache_miss_resolve(page_id, out));
     } else {
       ++control_block_->stat_snapshot_cache_hits_;
+      *out = snapshot_page_pool_->get_base() + offset;
     }
-    ASSERT_ND(offset != 0);
-    *out = snapshot_page_pool_->get_base() + offset;
   } else {
     ASSERT_ND(!engine_->get_options().cache_.snapshot_cache_enabled_);
     // Snapshot is disabled. So far this happens only in performance experiments.
@@ -714,15 +804,11 @@ ErrorCode ThreadPimpl::find_or_read_snapshot_pages_batch(
         if (offset != 0) {
           DVLOG(0) << "Interesting, this race is rare, but possible. offset=" << offset;
         }
-        CHECK_ERROR_CODE(on_snapshot_cache_miss(page_id, &offset));
-        ASSERT_ND(offset != 0);
-        CHECK_ERROR_CODE(snapshot_cache_hashtable_->install(page_id, offset));
-        ++control_block_->stat_snapshot_cache_misses_;
+        CHECK_ERROR_CODE(on_snapshot_cache_miss_resolve(page_id, out + b));
       } else {
         ++control_block_->stat_snapshot_cache_hits_;
+        out[b] = snapshot_page_pool_->get_base() + offset;
       }
-      ASSERT_ND(offset != 0);
-      out[b] = snapshot_page_pool_->get_base() + offset;
     }
   } else {
     ASSERT_ND(!engine_->get_options().cache_.snapshot_cache_enabled_);
@@ -737,6 +823,77 @@ ErrorCode ThreadPimpl::find_or_read_snapshot_pages_batch(
   return kErrorCodeOk;
 }
 
+ErrorCode ThreadPimpl::on_snapshot_cache_miss_resolve(
+  storage::SnapshotPagePointer page_id,
+  storage::Page** out) {
+  if (!remote_snapshot_caches_.empty()) {
+    CHECK_ERROR_CODE(find_in_remote_snapshot_caches(page_id, out));
+    if (*out) {
+      ++control_block_->stat_snapshot_cache_remote_hits_;
+      return kErrorCodeOk;
+    }
+  }
+
+  memory::PagePoolOffset offset;
+  CHECK_ERROR_CODE(on_snapshot_cache_miss(page_id, &offset));
+  ASSERT_ND(offset != 0);
+  CHECK_ERROR_CODE(snapshot_cache_hashtable_->install(page_id, offset));
+  ++control_block_->stat_snapshot_cache_misses_;
+  *out = snapshot_page_pool_->get_base() + offset;
+  return kErrorCodeOk;
+}
+
+ErrorCode ThreadPimpl::find_in_remote_snapshot_caches(
+  storage::SnapshotPagePointer page_id,
+  storage::Page** out) {
+  *out = nullptr;
+  const uint16_t copy_threshold
+    = engine_->get_options().cache_.snapshot_cache_remote_copy_threshold_;
+  const uint64_t process_id = ::getpid();
+  for (cache::CacheManagerControlBlock* remote : remote_snapshot_caches_) {
+    if (!remote->is_accessible_from(process_id) || !remote->try_pin()) {
+      continue;
+    }
+    uint16_t refcount;
+    memory::PagePoolOffset remote_offset
+      = remote->hashtable_->find_and_get_refcount(page_id, &refcount);
+    if (remote_offset == 0
+      || remote_offset >= remote->pool_pages_
+      || remote->pool_base_[remote_offset].get_header().page_id_ != page_id) {
+      remote->unpin();
+      continue;
+    }
+
+    storage::Page* remote_page = remote->pool_base_ + remote_offset;
+    ++remote->stat_remote_hits_served_;
+    if (refcount < copy_threshold) {
+      // Not hot enough to be worth local memory. Just reference it.
+      // Like a page in the local cache, it stays there at least for the grace period.
+      remote->referenced_ = true;
+      remote->unpin();
+      *out = remote_page;
+      return kErrorCodeOk;
+    }
+
+    memory::PagePoolOffset offset = core_memory_->grab_free_snapshot_page();
+    if (offset == 0) {
+      remote->unpin();
+      return kErrorCodeOk;  // let the caller handle it
+    }
+    storage::Page* new_page = snapshot_page_pool_->get_base() + offset;
+    std::memcpy(reinterpret_cast<char*>(new_page), remote_page, storage::kPageSize);
+    remote->unpin();
+    if (new_page->get_header().page_id_ != page_id) {
+      // evicted and reused in the remote node while we were copying. super rare.
+      core_memory_->release_free_snapshot_page(offset);
+      continue;
+    }
+    CHECK_ERROR_CODE(snapshot_cache_hashtable_->install(page_id, offset));
+    *out = new_page;
+    return kErrorCodeOk;
+  }
+  return kErrorCodeOk;
+}
 
 ErrorCode ThreadPimpl::on_snapshot_cache_miss(
   storage::SnapshotPagePointer page_id,
@@ -1064,5 +1221,11 @@ ErrorCode ThreadPimpl::sysxct_batch_page_locks(
 static_assert(
   sizeof(ThreadControlBlock) <= soc::ThreadMemoryAnchors::kThreadMemorySize,
   "ThreadControlBlock is too large.");
+static_assert(
+  TaskQueue::kCapacity * TaskQueue::kSlotSize <= soc::ThreadMemoryAnchors::kTaskInputMemorySize,
+  "TaskQueue input slots don't fit in task input memory.");
+static_assert(
+  TaskQueue::kCapacity * TaskQueue::kSlotSize <= soc::ThreadMemoryAnchors::kTaskOutputMemorySize,
+  "TaskQueue output slots don't fit in task output memory.");
 }  // namespace thread
 }  // namespace foedus
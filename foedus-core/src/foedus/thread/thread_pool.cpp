@@ -63,6 +63,16 @@ bool ThreadPool::impersonate_on_numa_core(
   return pimpl_->impersonate_on_numa_core(core, proc_name, task_input, task_input_size, session);
 }
 
+bool ThreadPool::impersonate_pipelined_on_numa_node(
+  ThreadGroupId node,
+  PipelinedSession *session) {
+  return pimpl_->impersonate_pipelined_on_numa_node(node, session);
+}
+
+bool ThreadPool::impersonate_pipelined_on_numa_core(ThreadId core, PipelinedSession *session) {
+  return pimpl_->impersonate_pipelined_on_numa_core(core, session);
+}
+
 ThreadGroupRef* ThreadPool::get_group_ref(ThreadGroupId numa_node) {
   return pimpl_->get_group(numa_node);
 }
@@ -117,6 +117,25 @@ bool ThreadPoolPimpl::impersonate_on_numa_core(
   ThreadRef* thread = get_thread(core);
   return thread->try_impersonate(proc_name, task_input, task_input_size, session);
 }
+bool ThreadPoolPimpl::impersonate_pipelined_on_numa_node(
+  ThreadGroupId node,
+  PipelinedSession *session) {
+  uint16_t thread_per_group = engine_->get_options().thread_.thread_count_per_group_;
+  ThreadGroupRef& group = groups_[node];
+  for (size_t j = 0; j < thread_per_group; ++j) {
+    ThreadRef* thread = group.get_thread(j);
+    if (thread->try_impersonate_pipelined(session)) {
+      return true;
+    }
+  }
+  return false;
+}
+bool ThreadPoolPimpl::impersonate_pipelined_on_numa_core(
+  ThreadId core,
+  PipelinedSession *session) {
+  ThreadRef* thread = get_thread(core);
+  return thread->try_impersonate_pipelined(session);
+}
 
 std::ostream& operator<<(std::ostream& o, const ThreadPoolPimpl& v) {
   o << "<ThreadPool>";
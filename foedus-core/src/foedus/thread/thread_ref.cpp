@@ -27,6 +27,7 @@
 #include "foedus/soc/shared_memory_repo.hpp"
 #include "foedus/soc/soc_manager.hpp"
 #include "foedus/thread/impersonate_session.hpp"
+#include "foedus/thread/pipelined_session.hpp"
 #include "foedus/thread/thread_id.hpp"
 #include "foedus/thread/thread_pimpl.hpp"
 
@@ -100,6 +101,43 @@ bool ThreadRef::try_impersonate(
   return true;
 }
 
+bool ThreadRef::try_impersonate_pipelined(PipelinedSession *session) {
+  if (session->is_valid()) {
+    LOG(WARNING) << "This session is already attached to some thread. Releasing the current one..";
+    session->release();
+  }
+  if (UNLIKELY(control_block_->status_ == kNotInitialized)) {
+    while (control_block_->status_ == kNotInitialized) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      assorted::memory_fence_acquire();
+    }
+  }
+  if (control_block_->status_ != kWaitingForTask) {
+    DVLOG(0) << "(fast path) Someone already took Thread-" << id_ << ".";
+    return false;
+  }
+
+  {
+    soc::SharedMutexScope scope(&control_block_->task_mutex_);
+    if (control_block_->status_ != kWaitingForTask) {
+      DVLOG(0) << "(slow path) Someone already took Thread-" << id_ << ".";
+      return false;
+    }
+    session->submitted_ = 0;
+    session->reaped_ = 0;
+    session->session_.thread_ = this;
+    session->session_.ticket_ = ++control_block_->current_ticket_;
+    control_block_->proc_name_.clear();
+    control_block_->input_len_ = 0;
+    control_block_->task_queue_.initialize();
+    control_block_->task_queue_.active_ = true;
+    control_block_->status_ = kWaitingForExecution;
+  }
+  control_block_->wakeup_cond_.signal();
+  VLOG(0) << "Pipelined impersonation succeeded for Thread-" << id_ << ".";
+  return true;
+}
+
 ThreadGroupRef::ThreadGroupRef() : engine_(nullptr), group_id_(0) {
 }
 
@@ -124,9 +162,14 @@ uint64_t ThreadRef::get_snapshot_cache_misses() const {
   return control_block_->stat_snapshot_cache_misses_;
 }
 
+uint64_t ThreadRef::get_snapshot_cache_remote_hits() const {
+  return control_block_->stat_snapshot_cache_remote_hits_;
+}
+
 void ThreadRef::reset_snapshot_cache_counts() const {
   control_block_->stat_snapshot_cache_hits_ = 0;
   control_block_->stat_snapshot_cache_misses_ = 0;
+  control_block_->stat_snapshot_cache_remote_hits_ = 0;
 }
 
 Epoch ThreadGroupRef::get_min_in_commit_epoch() const {
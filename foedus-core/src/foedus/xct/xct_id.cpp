@@ -75,6 +75,20 @@ void RwLockableXctId::hotter(thread::Thread* context) const {
   foedus::storage::to_page(this)->get_header().hotness_.increment(&context->get_lock_rnd());
 }
 
+void CompactLockableXctId::lock() {
+  assorted::spin_until([this]{ return this->try_lock(); });
+  ASSERT_ND(is_keylocked());
+}
+
+XctId CompactLockableXctId::spin_while_locked() const {
+  uint64_t copied_data = assorted::atomic_load_acquire<uint64_t>(&data_);
+  while (copied_data & (kXctIdCompactLockBit | kXctIdBeingWrittenBit)) {
+    assorted::yield_if_valgrind();
+    copied_data = assorted::atomic_load_acquire<uint64_t>(&data_);
+  }
+  return to_xct_id(copied_data);
+}
+
 void McsWwLock::ownerless_acquire_lock() {
   McsWwOwnerlessImpl::ownerless_acquire_unconditional(this);
 }
@@ -192,6 +206,12 @@ std::ostream& operator<<(std::ostream& o, const LockableXctId& v) {
   return o;
 }
 
+std::ostream& operator<<(std::ostream& o, const CompactLockableXctId& v) {
+  o << "<CompactLockableXctId><locked>" << v.is_keylocked() << "</locked>"
+    << v.get_xct_id() << "</CompactLockableXctId>";
+  return o;
+}
+
 std::ostream& operator<<(std::ostream& o, const McsRwLock& v) {
   o << "<McsRwLock><locked>" << v.is_locked() << "</locked><tail_waiter>"
     << v.get_tail_waiter() << "</tail_waiter><tail_block>" << v.get_tail_waiter_block()
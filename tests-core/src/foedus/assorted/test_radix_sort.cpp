@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include <stdint.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "foedus/test_common.hpp"
+#include "foedus/assorted/radix_sort.hpp"
+#include "foedus/assorted/uniform_random.hpp"
+
+namespace foedus {
+namespace assorted {
+
+DEFINE_TEST_CASE_PACKAGE(RadixSortTest, foedus.assorted);
+
+/** Like snapshot sort entries: key in the high half, then epoch/ordinal, then position. */
+std::vector<__uint128_t> make_entries(uint32_t count, uint32_t distinct_keys) {
+  UniformRandom rnd(1234);
+  std::vector<__uint128_t> entries;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint64_t key = rnd.uniform_within(0, distinct_keys - 1U);
+    uint64_t low = (static_cast<uint64_t>(rnd.uniform_within(0, 3)) << 48) | i;
+    entries.push_back((static_cast<__uint128_t>(key) << 64) | low);
+  }
+  return entries;
+}
+
+void test_uint128(uint32_t count, uint32_t distinct_keys, uint16_t threads) {
+  std::vector<__uint128_t> entries = make_entries(count, distinct_keys);
+  std::vector<__uint128_t> expected = entries;
+  std::sort(expected.begin(), expected.end());
+  std::vector<__uint128_t> buffer(count);
+  radix_sort_uint128(&entries[0], &buffer[0], count, 0, threads);
+  EXPECT_TRUE(entries == expected);
+}
+
+TEST(RadixSortTest, Uint128) { test_uint128(10000, 1U << 30, 1); }
+TEST(RadixSortTest, Uint128FewKeys) { test_uint128(10000, 3, 1); }
+TEST(RadixSortTest, Uint128Parallel) { test_uint128(300000, 1000, 4); }
+
+TEST(RadixSortTest, IgnoredLowBytes) {
+  // the lowest 2 bytes are already ascending (positions). the result must still be fully sorted
+  // because the sort is stable.
+  const uint32_t kCount = 50000;
+  std::vector<__uint128_t> entries = make_entries(kCount, 100);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    entries[i] = (entries[i] & ~static_cast<__uint128_t>(0xFFFFU)) | (i & 0xFFFFU);
+    entries[i] &= ~(static_cast<__uint128_t>(0xFFFFFFU) << 16);  // same bytes 2-4
+  }
+  std::vector<__uint128_t> expected = entries;
+  std::stable_sort(expected.begin(), expected.end(), [](__uint128_t a, __uint128_t b) {
+    return (a >> 16) < (b >> 16);
+  });
+  std::vector<__uint128_t> buffer(kCount);
+  radix_sort_uint128(&entries[0], &buffer[0], kCount, 2);
+  EXPECT_TRUE(entries == expected);
+}
+
+/** Same layout as the 8-byte masstree partitioner's entry. */
+struct Entry24 {
+  uint64_t slice_;
+  uint64_t epoch_;
+  uint32_t position_;
+  uint32_t dummy_;
+  bool operator<(const Entry24& rhs) const {
+    if (slice_ != rhs.slice_) {
+      return slice_ < rhs.slice_;
+    } else if (epoch_ != rhs.epoch_) {
+      return epoch_ < rhs.epoch_;
+    }
+    return position_ < rhs.position_;
+  }
+};
+
+void test_entry24(uint16_t threads) {
+  const uint32_t kCount = 200000;
+  UniformRandom rnd(5678);
+  std::vector<Entry24> entries(kCount);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    entries[i].slice_ = rnd.next_uint64() % 5000U;
+    entries[i].epoch_ = (static_cast<uint64_t>(rnd.uniform_within(1, 2)) << 32) | (i % 77U);
+    entries[i].position_ = rnd.next_uint32();
+    entries[i].dummy_ = i;  // not compared. must move along with its entry
+  }
+  std::vector<Entry24> expected = entries;
+  std::sort(expected.begin(), expected.end());
+  std::vector<Entry24> buffer(kCount);
+  const uint8_t kByteOrder[] = {
+    16, 17, 18, 19,
+    8, 9, 10, 11, 12, 13, 14, 15,
+    0, 1, 2, 3, 4, 5, 6, 7};
+  radix_sort(&entries[0], &buffer[0], kCount, sizeof(Entry24), kByteOrder, sizeof(kByteOrder),
+    threads);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(expected[i].slice_, entries[i].slice_) << i;
+    EXPECT_EQ(expected[i].epoch_, entries[i].epoch_) << i;
+    EXPECT_EQ(expected[i].position_, entries[i].position_) << i;
+    EXPECT_EQ(expected[i].dummy_, entries[i].dummy_) << i;
+  }
+}
+
+TEST(RadixSortTest, Entry24) { test_entry24(1); }
+TEST(RadixSortTest, Entry24Parallel) { test_entry24(3); }
+
+}  // namespace assorted
+}  // namespace foedus
+
+TEST_MAIN_CAPTURE_SIGNALS(RadixSortTest, foedus.assorted);
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "foedus/engine.hpp"
+#include "foedus/engine_options.hpp"
+#include "foedus/test_common.hpp"
+#include "foedus/proc/proc_manager.hpp"
+#include "foedus/snapshot/snapshot_manager.hpp"
+#include "foedus/storage/storage_manager.hpp"
+#include "foedus/storage/array/array_metadata.hpp"
+#include "foedus/storage/array/array_storage.hpp"
+#include "foedus/thread/impersonate_session.hpp"
+#include "foedus/thread/thread.hpp"
+#include "foedus/thread/thread_pool.hpp"
+#include "foedus/xct/xct_manager.hpp"
+
+/**
+ * @file test_cache_remote_lookup.cpp
+ * Cache misses served by the snapshot cache of another node.
+ */
+namespace foedus {
+namespace cache {
+DEFINE_TEST_CASE_PACKAGE(CacheRemoteLookupTest, foedus.cache);
+
+const uint32_t kRecords = 4096;  // about 100 leaf pages
+const uint16_t kPayload = 64;
+const storage::StorageName kName("test");
+
+/** Output of read_all_task. Statistics while the task read all records. */
+struct ReadStat {
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t remote_hits_;
+};
+
+ErrorStack populate_task(const proc::ProcArguments& args) {
+  thread::Thread* context = args.context_;
+  storage::array::ArrayStorage array(args.engine_, kName);
+  xct::XctManager* xct_manager = args.engine_->get_xct_manager();
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint32_t i = 0; i < kRecords; ++i) {
+    storage::array::ArrayOffset rec = i;
+    WRAP_ERROR_CODE(array.overwrite_record(context, rec, &rec, 0, sizeof(rec)));
+  }
+  Epoch commit_epoch;
+  WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+  WRAP_ERROR_CODE(xct_manager->wait_for_commit(commit_epoch));
+  return kRetOk;
+}
+
+ErrorStack read_all_task(const proc::ProcArguments& args) {
+  thread::Thread* context = args.context_;
+  storage::array::ArrayStorage array(args.engine_, kName);
+  xct::XctManager* xct_manager = args.engine_->get_xct_manager();
+  context->reset_snapshot_cache_counts();
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint32_t i = 0; i < kRecords; ++i) {
+    storage::array::ArrayOffset data = 0;
+    WRAP_ERROR_CODE(array.get_record(context, i, &data, 0, sizeof(data)));
+    EXPECT_EQ(i, data);
+  }
+  Epoch commit_epoch;
+  WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+
+  ReadStat stat;
+  stat.hits_ = context->get_snapshot_cache_hits();
+  stat.misses_ = context->get_snapshot_cache_misses();
+  stat.remote_hits_ = context->get_snapshot_cache_remote_hits();
+  EXPECT_GE(args.output_buffer_size_, sizeof(stat));
+  std::memcpy(args.output_buffer_, &stat, sizeof(stat));
+  *args.output_used_ = sizeof(stat);
+  return kRetOk;
+}
+
+ReadStat read_all_on_node(Engine* engine, thread::ThreadGroupId node) {
+  thread::ImpersonateSession session;
+  EXPECT_TRUE(engine->get_thread_pool()->impersonate_on_numa_node(
+    node,
+    "read_all_task",
+    nullptr,
+    0,
+    &session));
+  COERCE_ERROR(session.get_result());
+  ReadStat stat;
+  EXPECT_EQ(sizeof(stat), session.get_output_size());
+  std::memcpy(&stat, session.get_raw_output_buffer(), sizeof(stat));
+  session.release();
+  return stat;
+}
+
+/**
+ * Node-0 reads everything from snapshot files, then Node-1 reads the same records.
+ * @param remote_lookup whether we enable remote lookups
+ * @param copy_threshold snapshot_cache_remote_copy_threshold_
+ */
+void test_remote(bool remote_lookup, uint16_t copy_threshold) {
+  EngineOptions options = get_tiny_options();
+  options.thread_.group_count_ = 2;
+  options.thread_.thread_count_per_group_ = 1;
+  options.log_.loggers_per_node_ = 1;
+  options.cache_.snapshot_cache_remote_lookup_ = remote_lookup;
+  options.cache_.snapshot_cache_remote_copy_threshold_ = copy_threshold;
+  {
+    Engine engine(options);
+    engine.get_proc_manager()->pre_register("populate_task", populate_task);
+    COERCE_ERROR(engine.initialize());
+    {
+      UninitializeGuard guard(&engine);
+      storage::array::ArrayStorage out;
+      Epoch commit_epoch;
+      storage::array::ArrayMetadata meta(kName, kPayload, kRecords);
+      COERCE_ERROR(engine.get_storage_manager()->create_array(&meta, &out, &commit_epoch));
+      COERCE_ERROR(engine.get_thread_pool()->impersonate_on_numa_node_synchronous(
+        0,
+        "populate_task"));
+      engine.get_snapshot_manager()->trigger_snapshot_immediate(true);
+      COERCE_ERROR(engine.uninitialize());
+    }
+  }
+  {
+    // All reads go to the snapshot after restart.
+    Engine engine(options);
+    engine.get_proc_manager()->pre_register("read_all_task", read_all_task);
+    COERCE_ERROR(engine.initialize());
+    {
+      UninitializeGuard guard(&engine);
+      ReadStat first = read_all_on_node(&engine, 0);
+      EXPECT_GT(first.misses_, 0U);
+      EXPECT_EQ(0U, first.remote_hits_);
+
+      ReadStat second = read_all_on_node(&engine, 1);
+      const bool reference = remote_lookup && copy_threshold == 0xFFFFU;
+      if (!remote_lookup) {
+        EXPECT_EQ(first.misses_, second.misses_);
+        EXPECT_EQ(0U, second.remote_hits_);
+      } else if (reference) {
+        // Node-1 never caches them, so every access goes to Node-0's cache
+        EXPECT_EQ(0U, second.misses_);
+        EXPECT_GE(second.remote_hits_, first.misses_);
+      } else {
+        // Node-1 copies each page from Node-0's cache once
+        EXPECT_EQ(0U, second.misses_);
+        EXPECT_EQ(first.misses_, second.remote_hits_);
+      }
+
+      ReadStat third = read_all_on_node(&engine, 1);
+      EXPECT_EQ(0U, third.misses_);
+      if (reference) {
+        EXPECT_EQ(second.remote_hits_, third.remote_hits_);
+        EXPECT_EQ(0U, third.hits_);
+      } else {
+        EXPECT_EQ(0U, third.remote_hits_);
+      }
+      COERCE_ERROR(engine.uninitialize());
+    }
+  }
+  cleanup_test(options);
+}
+
+TEST(CacheRemoteLookupTest, Disabled) { test_remote(false, 0); }
+TEST(CacheRemoteLookupTest, AlwaysCopy) { test_remote(true, 0); }
+TEST(CacheRemoteLookupTest, Reference) { test_remote(true, 0xFFFFU); }
+
+}  // namespace cache
+}  // namespace foedus
+
+TEST_MAIN_CAPTURE_SIGNALS(CacheRemoteLookupTest, foedus.cache);
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "foedus/engine.hpp"
+#include "foedus/engine_options.hpp"
+#include "foedus/test_common.hpp"
+#include "foedus/cache/cache_manager.hpp"
+#include "foedus/fs/filesystem.hpp"
+#include "foedus/fs/path.hpp"
+#include "foedus/proc/proc_manager.hpp"
+#include "foedus/snapshot/snapshot_manager.hpp"
+#include "foedus/storage/storage_manager.hpp"
+#include "foedus/storage/array/array_metadata.hpp"
+#include "foedus/storage/array/array_storage.hpp"
+#include "foedus/thread/thread.hpp"
+#include "foedus/thread/thread_pool.hpp"
+#include "foedus/xct/xct_manager.hpp"
+
+/**
+ * @file test_cache_warmup.cpp
+ * Warm restart of snapshot cache from the hot-page file.
+ */
+namespace foedus {
+namespace cache {
+DEFINE_TEST_CASE_PACKAGE(CacheWarmupTest, foedus.cache);
+
+const uint32_t kRecords = 4096;  // about 100 leaf pages
+const uint16_t kPayload = 64;
+const storage::StorageName kName("test");
+
+/** Places the hot-page file under the test folder so that cleanup_test() removes it. */
+void set_hot_page_file_pattern(EngineOptions* options) {
+  fs::Path folder = fs::Path(options->savepoint_.savepoint_path_.str()).parent_path();
+  fs::create_directories(folder);
+  folder /= "hot_pages_$NODE$.bin";
+  options->cache_.snapshot_cache_hot_page_file_pattern_.assign(folder.string());
+}
+
+ErrorStack populate_task(const proc::ProcArguments& args) {
+  thread::Thread* context = args.context_;
+  storage::array::ArrayStorage array(args.engine_, kName);
+  xct::XctManager* xct_manager = args.engine_->get_xct_manager();
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint32_t i = 0; i < kRecords; ++i) {
+    storage::array::ArrayOffset rec = i;
+    WRAP_ERROR_CODE(array.overwrite_record(context, rec, &rec, 0, sizeof(rec)));
+  }
+  Epoch commit_epoch;
+  WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+  WRAP_ERROR_CODE(xct_manager->wait_for_commit(commit_epoch));
+  return kRetOk;
+}
+
+/** Input is a bool, whether we expect the cache is already warmed up. */
+ErrorStack read_all_task(const proc::ProcArguments& args) {
+  EXPECT_EQ(sizeof(bool), args.input_len_);
+  const bool warm = *reinterpret_cast<const bool*>(args.input_buffer_);
+  CacheManager* cache_manager = args.engine_->get_cache_manager();
+  while (!cache_manager->is_warmup_done()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (warm) {
+    EXPECT_GT(cache_manager->get_warmup_pages(), 0U);
+  } else {
+    EXPECT_EQ(0U, cache_manager->get_warmup_pages());
+  }
+
+  thread::Thread* context = args.context_;
+  storage::array::ArrayStorage array(args.engine_, kName);
+  xct::XctManager* xct_manager = args.engine_->get_xct_manager();
+  uint64_t misses_before = context->get_snapshot_cache_misses();
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint32_t i = 0; i < kRecords; ++i) {
+    storage::array::ArrayOffset data = 0;
+    WRAP_ERROR_CODE(array.get_record(context, i, &data, 0, sizeof(data)));
+    EXPECT_EQ(i, data);
+  }
+  Epoch commit_epoch;
+  WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+  uint64_t misses = context->get_snapshot_cache_misses() - misses_before;
+  if (warm) {
+    EXPECT_EQ(0U, misses);
+  } else {
+    EXPECT_GT(misses, 0U);
+  }
+  return kRetOk;
+}
+
+TEST(CacheWarmupTest, WarmRestart) {
+  EngineOptions options = get_tiny_options();
+  options.thread_.thread_count_per_group_ = 1;
+  set_hot_page_file_pattern(&options);
+  options.cache_.snapshot_cache_hot_page_save_interval_ms_ = 0;
+  fs::Path hot_page_file(options.cache_.convert_snapshot_cache_hot_page_file_pattern(0));
+  {
+    Engine engine(options);
+    engine.get_proc_manager()->pre_register("populate_task", populate_task);
+    COERCE_ERROR(engine.initialize());
+    {
+      UninitializeGuard guard(&engine);
+      storage::array::ArrayStorage out;
+      Epoch commit_epoch;
+      storage::array::ArrayMetadata meta(kName, kPayload, kRecords);
+      COERCE_ERROR(engine.get_storage_manager()->create_array(&meta, &out, &commit_epoch));
+      COERCE_ERROR(engine.get_thread_pool()->impersonate_synchronous("populate_task"));
+      engine.get_snapshot_manager()->trigger_snapshot_immediate(true);
+      COERCE_ERROR(engine.uninitialize());
+    }
+  }
+
+  // All reads go to the snapshot after restart. The cold run fills the cache and saves it.
+  bool warm = false;
+  {
+    Engine engine(options);
+    engine.get_proc_manager()->pre_register("read_all_task", read_all_task);
+    COERCE_ERROR(engine.initialize());
+    {
+      UninitializeGuard guard(&engine);
+      COERCE_ERROR(engine.get_thread_pool()->impersonate_synchronous(
+        "read_all_task",
+        &warm,
+        sizeof(warm)));
+      COERCE_ERROR(engine.uninitialize());
+    }
+  }
+  EXPECT_TRUE(fs::exists(hot_page_file));
+
+  // The next run prefetches them, so the same reads cause no cache misses.
+  warm = true;
+  {
+    Engine engine(options);
+    engine.get_proc_manager()->pre_register("read_all_task", read_all_task);
+    COERCE_ERROR(engine.initialize());
+    {
+      UninitializeGuard guard(&engine);
+      COERCE_ERROR(engine.get_thread_pool()->impersonate_synchronous(
+        "read_all_task",
+        &warm,
+        sizeof(warm)));
+      COERCE_ERROR(engine.uninitialize());
+    }
+  }
+  cleanup_test(options);
+}
+
+TEST(CacheWarmupTest, CorruptedFile) {
+  // A broken hot-page file must not prevent the engine from starting up.
+  EngineOptions options = get_tiny_options();
+  set_hot_page_file_pattern(&options);
+  {
+    fs::Path hot_page_file(options.cache_.convert_snapshot_cache_hot_page_file_pattern(0));
+    std::ofstream file(hot_page_file.c_str(), std::ofstream::binary);
+    file << "this is not a hot-page file";
+  }
+  {
+    Engine engine(options);
+    COERCE_ERROR(engine.initialize());
+    {
+      UninitializeGuard guard(&engine);
+      COERCE_ERROR(engine.uninitialize());
+    }
+  }
+  cleanup_test(options);
+}
+
+}  // namespace cache
+}  // namespace foedus
+
+TEST_MAIN_CAPTURE_SIGNALS(CacheWarmupTest, foedus.cache);
@@ -217,6 +217,37 @@ void test_evict(const uint32_t kHashTableSize, const uint32_t kCounts) {
   }
 }
 
+TEST(HashTableTest, CollectHotEntries) {
+  CacheHashtable hashtable(123456, 0);
+  for (uint32_t i = 0; i < 1000U; ++i) {
+    storage::SnapshotPagePointer pointer = storage::to_snapshot_page_pointer(1, 0, i);
+    EXPECT_EQ(kErrorCodeOk, hashtable.install(pointer, i + 42));
+    // page i is referenced i % 10 more times. refcount is 1 after install.
+    for (uint32_t j = 0; j < i % 10U; ++j) {
+      EXPECT_EQ(i + 42U, hashtable.find(pointer));
+    }
+  }
+
+  std::vector<CacheHashtable::HotEntry> entries;
+  hashtable.collect_hot_entries(200, &entries);
+  ASSERT_EQ(200U, entries.size());
+  for (uint32_t i = 0; i < entries.size(); ++i) {
+    // pages with i % 10 == 8 and 9 are the hottest. 100 pages each.
+    uint32_t page = entries[i].content_ - 42U;
+    EXPECT_GE(page % 10U, 8U) << i;
+    EXPECT_EQ(page % 10U + 1U, entries[i].refcount_) << i;
+    EXPECT_EQ(HashFunc::get_tag(storage::to_snapshot_page_pointer(1, 0, page)), entries[i].tag_);
+    if (i > 0) {
+      EXPECT_GE(entries[i - 1].refcount_, entries[i].refcount_) << i;
+    }
+  }
+
+  hashtable.collect_hot_entries(5000, &entries);
+  EXPECT_EQ(1000U, entries.size());
+  hashtable.collect_hot_entries(0, &entries);
+  EXPECT_EQ(0U, entries.size());
+}
+
 TEST(HashTableTest, EvictLittleEntries) { test_evict(12345, 10); }
 TEST(HashTableTest, EvictNoOverflow) { test_evict(12345, 1000); }
 TEST(HashTableTest, EvictLittleOverflow) { test_evict(12345, 2000); }
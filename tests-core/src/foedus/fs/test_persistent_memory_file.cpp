@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "foedus/test_common.hpp"
+#include "foedus/fs/filesystem.hpp"
+#include "foedus/fs/persistent_memory_file.hpp"
+
+/**
+ * @file test_persistent_memory_file.cpp
+ * Testcases for PersistentMemoryFile.
+ */
+namespace foedus {
+namespace fs {
+DEFINE_TEST_CASE_PACKAGE(PersistentMemoryFileTest, foedus.fs);
+
+std::vector<char> read_whole_file(const Path& path) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void test_append_reopen(const Path& path) {
+  char data[1000];
+  for (uint32_t i = 0; i < sizeof(data); ++i) {
+    data[i] = static_cast<char>(i);
+  }
+  {
+    PersistentMemoryFile file(path);
+    COERCE_ERROR_CODE(file.open());
+    EXPECT_EQ(0U, file.get_current_offset());
+    EXPECT_GE(file.get_capacity(), static_cast<uint64_t>(PersistentMemoryFile::kCapacityChunk));
+    COERCE_ERROR_CODE(file.append(sizeof(data), data));
+    COERCE_ERROR_CODE(file.append(13, data));  // neither aligned nor a multiple of 8
+    file.persist();
+    EXPECT_EQ(sizeof(data) + 13U, file.get_current_offset());
+    EXPECT_TRUE(file.close());
+  }
+  EXPECT_EQ(sizeof(data) + 13U, file_size(path));  // close() trims the capacity
+
+  {
+    PersistentMemoryFile file(path);
+    COERCE_ERROR_CODE(file.open());
+    EXPECT_EQ(sizeof(data) + 13U, file.get_current_offset());
+    COERCE_ERROR_CODE(file.append(7, data + 100));
+    EXPECT_TRUE(file.close());
+  }
+
+  std::vector<char> content = read_whole_file(path);
+  ASSERT_EQ(sizeof(data) + 13U + 7U, content.size());
+  EXPECT_EQ(0, std::memcmp(&content[0], data, sizeof(data)));
+  EXPECT_EQ(0, std::memcmp(&content[sizeof(data)], data, 13));
+  EXPECT_EQ(0, std::memcmp(&content[sizeof(data) + 13U], data + 100, 7));
+}
+
+TEST(PersistentMemoryFileTest, AppendReopen) {
+  Path path(std::string("testfile_") + get_random_name());
+  test_append_reopen(path);
+  remove(path);
+}
+
+TEST(PersistentMemoryFileTest, AppendReopenDevShm) {
+  Path folder_path(std::string("/dev/shm/foedus_test"));
+  folder_path /= get_random_name();
+  Path path(folder_path);
+  path /= get_random_name();
+  test_append_reopen(path);  // open() creates the folder
+  remove_all(folder_path);
+}
+
+TEST(PersistentMemoryFileTest, Truncate) {
+  Path path(std::string("testfile_") + get_random_name());
+  std::vector<char> ones(1 << 13, 1);
+  std::vector<char> twos(1 << 12, 2);
+  {
+    PersistentMemoryFile file(path);
+    COERCE_ERROR_CODE(file.open());
+    COERCE_ERROR_CODE(file.append(ones.size(), &ones[0]));
+    file.persist();
+    // as if we crashed here and restarted with the durable offset at 4kb
+    COERCE_ERROR_CODE(file.truncate(1 << 12));
+    EXPECT_EQ(1U << 12, file.get_current_offset());
+    COERCE_ERROR_CODE(file.append(twos.size(), &twos[0]));
+    EXPECT_TRUE(file.close());
+  }
+  std::vector<char> content = read_whole_file(path);
+  ASSERT_EQ(1U << 13, content.size());
+  EXPECT_EQ(0, std::memcmp(&content[0], &ones[0], 1 << 12));
+  EXPECT_EQ(0, std::memcmp(&content[1 << 12], &twos[0], 1 << 12));
+  remove(path);
+}
+
+}  // namespace fs
+}  // namespace foedus
+
+TEST_MAIN_CAPTURE_SIGNALS(PersistentMemoryFileTest, foedus.fs);
@@ -116,8 +116,10 @@ ErrorStack test_write_log(const proc::ProcArguments& args) {
   return kRetOk;
 }
 
-TEST(LogBasicTest, WriteLog) {
+void run_write_log(bool coalesce, bool persistent_memory = false) {
   EngineOptions options = get_tiny_options();
+  options.log_.coalesce_epoch_writes_ = coalesce;
+  options.log_.persistent_memory_log_ = persistent_memory;
   Engine engine(options);
   engine.get_proc_manager()->pre_register(proc::ProcAndName("test_write_log", test_write_log));
   COERCE_ERROR(engine.initialize());
@@ -129,6 +131,10 @@ TEST(LogBasicTest, WriteLog) {
   cleanup_test(options);
 }
 
+TEST(LogBasicTest, WriteLog) { run_write_log(true); }
+TEST(LogBasicTest, WriteLogNoCoalesce) { run_write_log(false); }
+TEST(LogBasicTest, WriteLogPersistentMemory) { run_write_log(true, true); }
+
 ErrorStack test_buffer_wrap_around(const proc::ProcArguments& args) {
   thread::Thread* context = args.context_;
   xct::XctManager* xct_manager = context->get_engine()->get_xct_manager();
@@ -198,11 +204,17 @@ ErrorStack test_buffer_wrap_around(const proc::ProcArguments& args) {
   return kRetOk;
 }
 
-TEST(LogBasicTest, BufferWrapAround) {
+void run_buffer_wrap_around(
+  bool coalesce,
+  uint32_t coalesce_buffer_kb,
+  bool persistent_memory = false) {
   EngineOptions options = get_tiny_options();
 
   // make it extremely small so that we can test wrap around
   options.log_.log_buffer_kb_ = 16;
+  options.log_.coalesce_epoch_writes_ = coalesce;
+  options.log_.coalesce_buffer_kb_ = coalesce_buffer_kb;
+  options.log_.persistent_memory_log_ = persistent_memory;
   Engine engine(options);
   engine.get_proc_manager()->pre_register(proc::ProcAndName(
     "test_buffer_wrap_around",
@@ -216,6 +228,20 @@ TEST(LogBasicTest, BufferWrapAround) {
   cleanup_test(options);
 }
 
+TEST(LogBasicTest, BufferWrapAround) {
+  run_buffer_wrap_around(true, LogOptions::kDefaultCoalesceBufferKb);
+}
+TEST(LogBasicTest, BufferWrapAroundNoCoalesce) {
+  run_buffer_wrap_around(false, LogOptions::kDefaultCoalesceBufferKb);
+}
+TEST(LogBasicTest, BufferWrapAroundSmallStaging) {
+  // the 16kb log spans several chunks of the 4kb staging buffer
+  run_buffer_wrap_around(true, 4);
+}
+TEST(LogBasicTest, BufferWrapAroundPersistentMemory) {
+  run_buffer_wrap_around(true, LogOptions::kDefaultCoalesceBufferKb, true);
+}
+
 }  // namespace log
 }  // namespace foedus
 
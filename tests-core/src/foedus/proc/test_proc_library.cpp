@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+/**
+ * @file test_proc_library.cpp
+ * @brief A shared library of procedures loaded by test_proc_manager.
+ * @details
+ * Compiled twice with different FOEDUS_TEST_PROC_LIBRARY_VERSION.
+ * Each version outputs its version number so that the testcase can tell which one is running.
+ */
+#include <stdint.h>
+
+#include "foedus/error_stack.hpp"
+#include "foedus/proc/proc_id.hpp"
+
+namespace foedus {
+namespace proc {
+
+ErrorStack library_proc(const ProcArguments& args) {
+  *reinterpret_cast<uint32_t*>(args.output_buffer_) = FOEDUS_TEST_PROC_LIBRARY_VERSION;
+  *args.output_used_ = sizeof(uint32_t);
+  return kRetOk;
+}
+
+ErrorStack library_proc_only_in_version(const ProcArguments& args) {
+  *args.output_used_ = 0;
+  return kRetOk;
+}
+
+}  // namespace proc
+}  // namespace foedus
+
+extern "C" uint32_t foedus_proc_library_init(foedus::proc::ProcAndName* out, uint32_t capacity) {
+  if (capacity < 2U) {
+    return 0;
+  }
+  out[0] = foedus::proc::ProcAndName("library_proc", &foedus::proc::library_proc);
+#if FOEDUS_TEST_PROC_LIBRARY_VERSION == 1
+  out[1] = foedus::proc::ProcAndName("only_in_v1", &foedus::proc::library_proc_only_in_version);
+#else  // FOEDUS_TEST_PROC_LIBRARY_VERSION == 1
+  out[1] = foedus::proc::ProcAndName("only_in_v2", &foedus::proc::library_proc_only_in_version);
+#endif  // FOEDUS_TEST_PROC_LIBRARY_VERSION == 1
+  return 2U;
+}
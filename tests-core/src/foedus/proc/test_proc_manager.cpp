@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include <stdint.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "foedus/engine.hpp"
+#include "foedus/engine_options.hpp"
+#include "foedus/test_common.hpp"
+#include "foedus/proc/proc_id.hpp"
+#include "foedus/proc/proc_manager.hpp"
+#include "foedus/thread/impersonate_session.hpp"
+#include "foedus/thread/thread_pool.hpp"
+
+namespace foedus {
+namespace proc {
+DEFINE_TEST_CASE_PACKAGE(ProcManagerTest, foedus.proc);
+
+#define X_QUOTE(str) #str
+#define X_EXPAND_AND_QUOTE(str) X_QUOTE(str)
+// -DFOEDUS_TEST_PROC_LIBRARY_DIR is given just for this testcase
+const std::string kLibraryDir = X_EXPAND_AND_QUOTE(FOEDUS_TEST_PROC_LIBRARY_DIR);
+#undef X_EXPAND_AND_QUOTE
+#undef X_QUOTE
+const std::string kLibraryV1 = kLibraryDir + "/libfoedus_test_proc_library_v1.so";
+const std::string kLibraryV2 = kLibraryDir + "/libfoedus_test_proc_library_v2.so";
+
+template <uint32_t VALUE>
+ErrorStack output_value(const ProcArguments& args) {
+  *reinterpret_cast<uint32_t*>(args.output_buffer_) = VALUE;
+  *args.output_used_ = sizeof(uint32_t);
+  return kRetOk;
+}
+
+/** Loads the shared library given as input in the SOC this runs on. */
+ErrorStack reload_proc(const ProcArguments& args) {
+  std::string path(reinterpret_cast<const char*>(args.input_buffer_), args.input_len_);
+  return args.engine_->get_proc_manager()->load_shared_library(path);
+}
+
+uint32_t run_and_get_output(Engine* engine, const ProcName& name) {
+  thread::ImpersonateSession session;
+  EXPECT_TRUE(engine->get_thread_pool()->impersonate(name, nullptr, 0, &session));
+  COERCE_ERROR(session.get_result());
+  EXPECT_EQ(sizeof(uint32_t), session.get_output_size());
+  uint32_t output;
+  session.get_output(&output);
+  return output;
+}
+
+ProcName to_name(uint32_t i) {
+  ProcName name("proc_");
+  name.append(std::to_string(i));
+  return name;
+}
+
+TEST(ProcManagerTest, SortedLookup) {
+  const uint32_t kProcs = 200;
+  std::vector<uint32_t> order;
+  for (uint32_t i = 0; i < kProcs; ++i) {
+    order.push_back(i);
+  }
+  std::random_shuffle(order.begin(), order.end());
+
+  EngineOptions options = get_tiny_options();
+  Engine engine(options);
+  ProcManager* manager = engine.get_proc_manager();
+  const Proc kProcs3[3] = { output_value<0>, output_value<1>, output_value<2> };
+  for (uint32_t i : order) {
+    manager->pre_register(to_name(i), kProcs3[i % 3U]);
+  }
+  COERCE_ERROR(engine.initialize());
+  {
+    UninitializeGuard guard(&engine);
+    std::vector<LocalProcId> ids;
+    for (uint32_t i = 0; i < kProcs; ++i) {
+      ProcName name = to_name(i);
+      LocalProcId id;
+      COERCE_ERROR(manager->get_local_proc_id(0, name, &id));
+      EXPECT_NE(kLocalProcInvalid, id);
+      ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    EXPECT_TRUE(std::unique(ids.begin(), ids.end()) == ids.end());
+    LocalProcId dummy;
+    EXPECT_TRUE(manager->get_local_proc_id(0, "proc_", &dummy).is_error());
+    EXPECT_TRUE(manager->get_local_proc_id(0, "proc_9999", &dummy).is_error());
+    EXPECT_TRUE(manager->get_local_proc_id(0, "zzz", &dummy).is_error());
+    EXPECT_TRUE(manager->get_local_proc_id(0, "", &dummy).is_error());
+
+    for (uint32_t i = 0; i < kProcs; i += 7U) {
+      ProcName name = to_name(i);
+      EXPECT_EQ(i % 3U, run_and_get_output(&engine, name)) << name;
+    }
+    EXPECT_EQ(0, manager->get_library_version(0));
+    COERCE_ERROR(engine.uninitialize());
+  }
+  cleanup_test(options);
+}
+
+TEST(ProcManagerTest, LoadPath) {
+  EngineOptions options = get_tiny_options();
+  options.proc_.shared_library_path_pattern_.assign(kLibraryV1);
+  Engine engine(options);
+  COERCE_ERROR(engine.initialize());
+  {
+    UninitializeGuard guard(&engine);
+    ProcManager* manager = engine.get_proc_manager();
+    EXPECT_EQ(1U, manager->get_library_version(0));
+    EXPECT_EQ(1U, run_and_get_output(&engine, "library_proc"));
+    LocalProcId dummy;
+    COERCE_ERROR(manager->get_local_proc_id(0, "only_in_v1", &dummy));
+    EXPECT_TRUE(manager->get_local_proc_id(0, "only_in_v2", &dummy).is_error());
+    COERCE_ERROR(engine.uninitialize());
+  }
+  cleanup_test(options);
+}
+
+TEST(ProcManagerTest, LoadDirectory) {
+  EngineOptions options = get_tiny_options();
+  options.proc_.shared_library_dir_pattern_.assign(kLibraryDir);
+  Engine engine(options);
+  COERCE_ERROR(engine.initialize());
+  {
+    UninitializeGuard guard(&engine);
+    ProcManager* manager = engine.get_proc_manager();
+    // v1 then v2 in the order of file names. v2 replaces library_proc.
+    EXPECT_EQ(2U, manager->get_library_version(0));
+    EXPECT_EQ(2U, run_and_get_output(&engine, "library_proc"));
+    LocalProcId dummy;
+    COERCE_ERROR(manager->get_local_proc_id(0, "only_in_v1", &dummy));
+    COERCE_ERROR(manager->get_local_proc_id(0, "only_in_v2", &dummy));
+    COERCE_ERROR(engine.uninitialize());
+  }
+  cleanup_test(options);
+}
+
+TEST(ProcManagerTest, HotReload) {
+  EngineOptions options = get_tiny_options();
+  options.proc_.shared_library_path_pattern_.assign(kLibraryV1);
+  Engine engine(options);
+  engine.get_proc_manager()->pre_register("reload_proc", reload_proc);
+  COERCE_ERROR(engine.initialize());
+  {
+    UninitializeGuard guard(&engine);
+    ProcManager* manager = engine.get_proc_manager();
+    LocalProcId id_before;
+    COERCE_ERROR(manager->get_local_proc_id(0, "library_proc", &id_before));
+    EXPECT_EQ(1U, run_and_get_output(&engine, "library_proc"));
+
+    COERCE_ERROR(engine.get_thread_pool()->impersonate_synchronous(
+      "reload_proc",
+      kLibraryV2.data(),
+      kLibraryV2.size()));
+    EXPECT_EQ(2U, manager->get_library_version(0));
+    EXPECT_EQ(2U, run_and_get_output(&engine, "library_proc"));
+    LocalProcId id_after;
+    COERCE_ERROR(manager->get_local_proc_id(0, "library_proc", &id_after));
+    EXPECT_EQ(id_before, id_after);
+    LocalProcId dummy;
+    COERCE_ERROR(manager->get_local_proc_id(0, "only_in_v2", &dummy));
+
+    // Failure to load doesn't affect the current procedures.
+    const std::string kBadPath = kLibraryDir + "/no_such_library.so";
+    ErrorStack result = engine.get_thread_pool()->impersonate_synchronous(
+      "reload_proc",
+      kBadPath.data(),
+      kBadPath.size());
+    EXPECT_TRUE(result.is_error());
+    EXPECT_EQ(kErrorCodeProcLibraryLoadFailed, result.get_error_code());
+    EXPECT_EQ(2U, manager->get_library_version(0));
+    EXPECT_EQ(2U, run_and_get_output(&engine, "library_proc"));
+
+    // Can't be called in master
+    EXPECT_TRUE(manager->load_shared_library(kLibraryV1).is_error());
+    COERCE_ERROR(engine.uninitialize());
+  }
+  cleanup_test(options);
+}
+
+}  // namespace proc
+}  // namespace foedus
+
+TEST_MAIN_CAPTURE_SIGNALS(ProcManagerTest, foedus.proc);
@@ -253,7 +253,8 @@ void test_run(
   const proc::ProcName& proc_name,
   bool multiple_loggers,
   bool multiple_partitions,
-  int levels) {
+  int levels,
+  bool persistent_memory_log = false) {
   ASSERT_ND(levels >= 1 && levels <= 3);
   const bool three_levels = levels == 3;
   uint16_t payload = three_levels ? kThreeLevelPayload : kTwoLevelPayload;
@@ -267,6 +268,7 @@ void test_run(
     options.thread_.group_count_ = 1;
     options.log_.loggers_per_node_ = multiple_loggers ? kThreads : 1;
   }
+  options.log_.persistent_memory_log_ = persistent_memory_log;
   if (three_levels) {
     options.memory_.page_pool_size_mb_per_node_ *= 50;
     options.cache_.snapshot_cache_size_mb_per_node_ *= 50;
@@ -385,6 +387,10 @@ TEST(SnapshotArrayTest, HolesOneLogger3Lv) { test_run(kHoles, false, false, 3);
 TEST(SnapshotArrayTest, HolesTwoLoggers3Lv) { test_run(kHoles, true, false, 3); }
 TEST(SnapshotArrayTest, HolesTwoPartitions3Lv) { test_run(kHoles, true, true, 3); }
 
+// Logs written via mapped files must be read back by the mapper and survive the restart.
+TEST(SnapshotArrayTest, IncrementsTwoLoggersPmem) { test_run(kInc, true, false, 2, true); }
+TEST(SnapshotArrayTest, IncrementsTwoPartitionsPmem) { test_run(kInc, true, true, 2, true); }
+
 }  // namespace snapshot
 }  // namespace foedus
 
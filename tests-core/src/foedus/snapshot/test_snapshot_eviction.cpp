@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2014-2015, Hewlett-Packard Development Company, LP.
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details. You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * HP designates this particular file as subject to the "Classpath" exception
+ * as provided by HP in the LICENSE.txt file that accompanied this code.
+ */
+#include <gtest/gtest.h>
+
+#include "foedus/engine.hpp"
+#include "foedus/engine_options.hpp"
+#include "foedus/test_common.hpp"
+#include "foedus/memory/engine_memory.hpp"
+#include "foedus/memory/numa_node_memory.hpp"
+#include "foedus/memory/page_pool.hpp"
+#include "foedus/proc/proc_manager.hpp"
+#include "foedus/snapshot/snapshot_manager.hpp"
+#include "foedus/storage/storage_manager.hpp"
+#include "foedus/storage/masstree/masstree_metadata.hpp"
+#include "foedus/storage/masstree/masstree_storage.hpp"
+#include "foedus/thread/thread_pool.hpp"
+#include "foedus/xct/xct_manager.hpp"
+
+/**
+ * @file test_snapshot_eviction.cpp
+ * Eviction of cold volatile pages between snapshots.
+ */
+namespace foedus {
+namespace snapshot {
+DEFINE_TEST_CASE_PACKAGE(SnapshotEvictionTest, foedus.snapshot);
+const uint32_t kRecords = 4096;
+/** [0] is evicted (evict_hotness_threshold_=1), [1] is not (0). */
+const storage::StorageName kNames[] = {
+  storage::StorageName("cold"),
+  storage::StorageName("keep")};
+
+storage::masstree::MasstreeStorage get_storage(const proc::ProcArguments& args) {
+  EXPECT_EQ(sizeof(uint32_t), args.input_len_);
+  uint32_t which = *reinterpret_cast<const uint32_t*>(args.input_buffer_);
+  storage::masstree::MasstreeStorage masstree(args.engine_, kNames[which]);
+  ASSERT_ND(masstree.exists());
+  return masstree;
+}
+
+ErrorStack insert_task(const proc::ProcArguments& args) {
+  thread::Thread* context = args.context_;
+  storage::masstree::MasstreeStorage masstree = get_storage(args);
+  xct::XctManager* xct_manager = args.engine_->get_xct_manager();
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint64_t i = 0; i < kRecords; ++i) {
+    storage::masstree::KeySlice slice = storage::masstree::normalize_primitive<uint64_t>(i);
+    WRAP_ERROR_CODE(masstree.insert_record_normalized(context, slice, &i, sizeof(i)));
+  }
+  Epoch commit_epoch;
+  WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+  WRAP_ERROR_CODE(xct_manager->wait_for_commit(commit_epoch));
+  return kRetOk;
+}
+
+/** Overwrites all records with the same values. Then commits or aborts. */
+ErrorStack overwrite(const proc::ProcArguments& args, bool commit) {
+  thread::Thread* context = args.context_;
+  storage::masstree::MasstreeStorage masstree = get_storage(args);
+  xct::XctManager* xct_manager = args.engine_->get_xct_manager();
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint64_t i = 0; i < kRecords; ++i) {
+    storage::masstree::KeySlice slice = storage::masstree::normalize_primitive<uint64_t>(i);
+    WRAP_ERROR_CODE(masstree.overwrite_record_primitive_normalized<uint64_t>(context, slice, i, 0));
+  }
+  if (commit) {
+    Epoch commit_epoch;
+    WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+    WRAP_ERROR_CODE(xct_manager->wait_for_commit(commit_epoch));
+  } else {
+    // This leaves volatile pages installed for the overwrites, but with no new modification.
+    WRAP_ERROR_CODE(xct_manager->abort_xct(context));
+  }
+  return kRetOk;
+}
+ErrorStack overwrite_task(const proc::ProcArguments& args) { return overwrite(args, true); }
+ErrorStack touch_task(const proc::ProcArguments& args) { return overwrite(args, false); }
+
+ErrorStack verify_task(const proc::ProcArguments& args) {
+  thread::Thread* context = args.context_;
+  storage::masstree::MasstreeStorage masstree = get_storage(args);
+  CHECK_ERROR(masstree.verify_single_thread(context));
+  xct::XctManager* xct_manager = args.engine_->get_xct_manager();
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint64_t i = 0; i < kRecords; ++i) {
+    storage::masstree::KeySlice slice = storage::masstree::normalize_primitive<uint64_t>(i);
+    uint64_t data = 0;
+    ErrorCode ret
+      = masstree.get_record_primitive_normalized<uint64_t>(context, slice, &data, 0, true);
+    EXPECT_EQ(kErrorCodeOk, ret) << i;
+    EXPECT_EQ(i, data) << i;
+  }
+  Epoch commit_epoch;
+  WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+  return kRetOk;
+}
+
+void run(Engine* engine, const char* proc, uint32_t which) {
+  COERCE_ERROR(engine->get_thread_pool()->impersonate_synchronous(proc, &which, sizeof(which)));
+}
+
+uint64_t get_allocated_pages(Engine* engine) {
+  memory::PagePool* pool = engine->get_memory_manager()->get_node_memory(0)->get_volatile_pool();
+  return pool->get_stat().allocated_pages_;
+}
+
+/** Evicts and returns how many pages were returned to the volatile pool. */
+uint64_t evict(Engine* engine) {
+  uint64_t before = get_allocated_pages(engine);
+  engine->get_snapshot_manager()->trigger_eviction_immediate(true);
+  uint64_t after = get_allocated_pages(engine);
+  EXPECT_GE(before, after);
+  return before - after;
+}
+
+void register_procs(Engine* engine) {
+  engine->get_proc_manager()->pre_register("insert_task", insert_task);
+  engine->get_proc_manager()->pre_register("overwrite_task", overwrite_task);
+  engine->get_proc_manager()->pre_register("touch_task", touch_task);
+  engine->get_proc_manager()->pre_register("verify_task", verify_task);
+}
+
+TEST(SnapshotEvictionTest, Masstree) {
+  EngineOptions options = get_tiny_options();
+  options.snapshot_.evict_page_pool_percent_ = 0;  // only explicit evictions in this test
+  {
+    Engine engine(options);
+    register_procs(&engine);
+    COERCE_ERROR(engine.initialize());
+    {
+      UninitializeGuard guard(&engine);
+      for (uint32_t which = 0; which < 2U; ++which) {
+        storage::masstree::MasstreeStorage out;
+        Epoch commit_epoch;
+        storage::masstree::MasstreeMetadata meta(kNames[which]);
+        meta.snapshot_thresholds_.evict_hotness_threshold_ = (which == 0 ? 1U : 0U);
+        COERCE_ERROR(engine.get_storage_manager()->create_masstree(&meta, &out, &commit_epoch));
+        run(&engine, "insert_task", which);
+      }
+      engine.get_snapshot_manager()->trigger_snapshot_immediate(true);  // snapshot-1
+
+      // volatile pages installed but not modified since snapshot-1. they are evicted
+      run(&engine, "touch_task", 0);
+      EXPECT_GT(evict(&engine), 0U);
+      run(&engine, "verify_task", 0);
+
+      // the storage is not configured to evict
+      run(&engine, "touch_task", 1);
+      EXPECT_EQ(0U, evict(&engine));
+
+      // modified after snapshot-1, so we can't evict
+      run(&engine, "overwrite_task", 0);
+      EXPECT_EQ(0U, evict(&engine));
+      engine.get_snapshot_manager()->trigger_snapshot_immediate(true);  // snapshot-2
+
+      // snapshot-3 doesn't contain "cold", so its pointers are of snapshot-2.
+      run(&engine, "overwrite_task", 1);
+      engine.get_snapshot_manager()->trigger_snapshot_immediate(true);  // snapshot-3
+      run(&engine, "touch_task", 0);
+      EXPECT_GT(evict(&engine), 0U);
+      run(&engine, "verify_task", 0);
+      run(&engine, "verify_task", 1);
+      COERCE_ERROR(engine.uninitialize());
+    }
+  }
+  {
+    // after restart, we know only about snapshot-3. snapshot-2 is read from its metadata file
+    Engine engine(options);
+    register_procs(&engine);
+    COERCE_ERROR(engine.initialize());
+    {
+      UninitializeGuard guard(&engine);
+      run(&engine, "touch_task", 0);
+      EXPECT_GT(evict(&engine), 0U);
+      run(&engine, "verify_task", 0);
+      run(&engine, "verify_task", 1);
+      COERCE_ERROR(engine.uninitialize());
+    }
+  }
+  cleanup_test(options);
+}
+
+}  // namespace snapshot
+}  // namespace foedus
+
+TEST_MAIN_CAPTURE_SIGNALS(SnapshotEvictionTest, foedus.snapshot);
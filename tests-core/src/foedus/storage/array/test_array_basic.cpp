@@ -93,6 +93,18 @@ TEST(ArrayBasicTest, RangeCalculation2) {
   EXPECT_EQ(kArraySize, range.end_);
 }
 
+TEST(ArrayBasicTest, RecordsInLeafCompact) {
+  EXPECT_EQ(to_records_in_leaf(8U), to_records_in_leaf(8U, kRecordHeaderStandard));
+  EXPECT_EQ(kDataSize / 24U, to_records_in_leaf(8U, kRecordHeaderStandard));
+  EXPECT_EQ(kDataSize / 16U, to_records_in_leaf(8U, kRecordHeaderCompact));
+  EXPECT_EQ(kDataSize / 48U, to_records_in_leaf(32U, kRecordHeaderStandard));
+  EXPECT_EQ(kDataSize / 40U, to_records_in_leaf(32U, kRecordHeaderCompact));
+  for (uint16_t payload = 1; payload <= 32U; ++payload) {
+    EXPECT_GT(to_records_in_leaf(payload, kRecordHeaderCompact), to_records_in_leaf(payload));
+    EXPECT_LE(to_records_in_leaf(payload, kRecordHeaderCompact), kInteriorFanout);
+  }
+}
+
 TEST(ArrayBasicTest, Create) {
   EngineOptions options = get_tiny_options();
   Engine engine(options);
@@ -25,6 +25,7 @@
 #include "foedus/test_common.hpp"
 #include "foedus/memory/engine_memory.hpp"
 #include "foedus/proc/proc_manager.hpp"
+#include "foedus/snapshot/snapshot_manager.hpp"
 #include "foedus/storage/storage_manager.hpp"
 #include "foedus/storage/masstree/masstree_log_types.hpp"
 #include "foedus/storage/masstree/masstree_metadata.hpp"
@@ -209,6 +210,117 @@ void SortBasicFunctor(Partitioner partitioner) {
 TEST(MasstreePartitionerTest, SortBasic) {
   execute_test(&SortBasicFunctor);
 }
+
+/** Overwrites all records in the table. Executed in node-1 to emulate a workload shift. */
+ErrorStack overwrite_task(const proc::ProcArguments& args) {
+  thread::Thread* context = args.context_;
+  EXPECT_EQ(sizeof(uint32_t), args.input_len_);
+  uint32_t table_size = *reinterpret_cast<const uint32_t*>(args.input_buffer_);
+  MasstreeStorage storage(context->get_engine(), kTableName);
+  xct::XctManager* xct_manager = context->get_engine()->get_xct_manager();
+  Epoch commit_epoch;
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint32_t id = 0; id < table_size; ++id) {
+    uint32_t data = id + 1U;
+    WRAP_ERROR_CODE(storage.overwrite_record_normalized(context, nm(id), &data, 0, sizeof(data)));
+  }
+  WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+  WRAP_ERROR_CODE(xct_manager->wait_for_commit(commit_epoch));
+  return kRetOk;
+}
+
+ErrorStack verify_task(const proc::ProcArguments& args) {
+  thread::Thread* context = args.context_;
+  uint32_t table_size = *reinterpret_cast<const uint32_t*>(args.input_buffer_);
+  MasstreeStorage storage(context->get_engine(), kTableName);
+  xct::XctManager* xct_manager = context->get_engine()->get_xct_manager();
+  Epoch commit_epoch;
+  WRAP_ERROR_CODE(xct_manager->begin_xct(context, xct::kSerializable));
+  for (uint32_t id = 0; id < table_size; ++id) {
+    uint32_t data = 0;
+    WRAP_ERROR_CODE(storage.get_record_primitive_normalized<uint32_t>(
+      context,
+      nm(id),
+      &data,
+      0,
+      true));
+    EXPECT_EQ(id + 1U, data) << id;
+  }
+  WRAP_ERROR_CODE(xct_manager->precommit_xct(context, &commit_epoch));
+  return kRetOk;
+}
+
+TEST(MasstreePartitionerTest, FollowWorkloadShift) {
+  const uint32_t kTableSize = 1024;
+  EngineOptions options = get_tiny_options();
+  options.thread_.group_count_ = 2;
+  options.thread_.thread_count_per_group_ = 1;
+  Engine engine(options);
+  engine.get_proc_manager()->pre_register("populate_task", populate_task);
+  engine.get_proc_manager()->pre_register("overwrite_task", overwrite_task);
+  engine.get_proc_manager()->pre_register("verify_task", verify_task);
+  COERCE_ERROR(engine.initialize());
+  {
+    UninitializeGuard guard(&engine);
+    MasstreeStorage out;
+    Epoch commit_epoch;
+    MasstreeMetadata meta(kTableName);
+    COERCE_ERROR(engine.get_storage_manager()->create_masstree(&meta, &out, &commit_epoch));
+    uint32_t table_size = kTableSize;
+    for (uint16_t node = 0; node < 2U; ++node) {
+      COERCE_ERROR(engine.get_thread_pool()->impersonate_on_numa_node_synchronous(
+        node,
+        "populate_task",
+        &table_size,
+        sizeof(table_size)));
+    }
+    xct::XctManager* xct_manager = engine.get_xct_manager();
+    COERCE_ERROR_CODE(xct_manager->wait_for_commit(xct_manager->get_current_global_epoch()));
+    engine.get_snapshot_manager()->trigger_snapshot_immediate(true);
+
+    // the first snapshot follows the initial population, half in each node
+    Partitioner partitioner(&engine, out.get_id());
+    EXPECT_TRUE(partitioner.is_valid());
+    {
+      std::unique_ptr< Logs<64> > logs(new Logs<64>(partitioner));
+      for (int i = 0; i < 64; ++i) {
+        logs->add_log(2, i + 1, i * 16);
+      }
+      logs->partition_batch();
+      EXPECT_EQ(0, logs->partition_results_[0]);
+      EXPECT_EQ(1, logs->partition_results_[63]);
+    }
+
+    // then node-1 takes over all the accesses. the next snapshot should follow it.
+    COERCE_ERROR(engine.get_thread_pool()->impersonate_on_numa_node_synchronous(
+      1,
+      "overwrite_task",
+      &table_size,
+      sizeof(table_size)));
+    engine.get_snapshot_manager()->trigger_snapshot_immediate(true);
+    EXPECT_TRUE(partitioner.is_valid());
+    {
+      std::unique_ptr< Logs<64> > logs(new Logs<64>(partitioner));
+      for (int i = 0; i < 64; ++i) {
+        logs->add_log(2, i + 1, i * 16);
+      }
+      logs->partition_batch();
+      for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(1, logs->partition_results_[i]) << i;
+      }
+    }
+
+    // the data are intact after the re-assignment
+    COERCE_ERROR(engine.get_thread_pool()->impersonate_on_numa_node_synchronous(
+      0,
+      "verify_task",
+      &table_size,
+      sizeof(table_size)));
+    COERCE_ERROR(engine.uninitialize());
+  }
+  cleanup_test(options);
+}
+
 }  // namespace masstree
 }  // namespace storage
 }  // namespace foedus
@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <vector>
@@ -30,6 +31,7 @@
 #include "foedus/soc/shared_rendezvous.hpp"
 #include "foedus/soc/soc_manager.hpp"
 #include "foedus/thread/impersonate_session.hpp"
+#include "foedus/thread/pipelined_session.hpp"
 #include "foedus/thread/thread.hpp"
 #include "foedus/thread/thread_pool.hpp"
 #include "foedus/thread/thread_ref.hpp"
@@ -108,6 +110,110 @@ TEST(ThreadPoolTest, SchedNormal) { run_sched(kScheduleRr, kPriorityDefault); }
 TEST(ThreadPoolTest, SchedLowest) { run_sched(kScheduleRr, kPriorityLowest); }
 TEST(ThreadPoolTest, SchedRealtime) { run_sched(kScheduleFifo, kPriorityHighest); }
 
+ErrorStack increment_task(const proc::ProcArguments& args) {
+  EXPECT_EQ(sizeof(uint64_t), args.input_len_);
+  uint64_t value = *reinterpret_cast<const uint64_t*>(args.input_buffer_);
+  *reinterpret_cast<uint64_t*>(args.output_buffer_) = value + 1U;
+  *args.output_used_ = sizeof(uint64_t);
+  return kRetOk;
+}
+
+ErrorStack failing_task(const proc::ProcArguments& /*args*/) {
+  return ERROR_STACK(kErrorCodeInvalidParameter);
+}
+
+void run_pipelined(bool batch) {
+  const uint64_t kTasks = 1000;
+  EngineOptions options = get_tiny_options();
+  Engine engine(options);
+  engine.get_proc_manager()->pre_register("increment_task", increment_task);
+  engine.get_proc_manager()->pre_register("failing_task", failing_task);
+  COERCE_ERROR(engine.initialize());
+  {
+    UninitializeGuard guard(&engine);
+    PipelinedSession session;
+    EXPECT_TRUE(engine.get_thread_pool()->impersonate_pipelined_on_numa_node(0, &session));
+    ASSERT_TRUE(session.is_valid());
+    proc::LocalProcId increment_id;
+    proc::LocalProcId failing_id;
+    COERCE_ERROR(session.resolve_proc("increment_task", &increment_id));
+    COERCE_ERROR(session.resolve_proc("failing_task", &failing_id));
+    proc::LocalProcId dummy;
+    EXPECT_TRUE(session.resolve_proc("no_such_task", &dummy).is_error());
+
+    std::vector<uint64_t> inputs(kTasks);
+    for (uint64_t i = 0; i < kTasks; ++i) {
+      inputs[i] = i * 3U;
+    }
+    const uint32_t kChunk = 16;
+    uint64_t submitted = 0;
+    uint64_t reaped = 0;
+    while (reaped < kTasks) {
+      if (batch) {
+        proc::LocalProcId ids[kChunk];
+        const void* input_ptrs[kChunk];
+        uint32_t input_lens[kChunk];
+        uint32_t count = 0;
+        for (; count < kChunk && submitted + count < kTasks; ++count) {
+          ids[count] = increment_id;
+          input_ptrs[count] = &inputs[submitted + count];
+          input_lens[count] = sizeof(uint64_t);
+        }
+        submitted += session.submit_batch(count, ids, input_ptrs, input_lens);
+      } else {
+        while (submitted < kTasks
+          && session.submit(increment_id, &inputs[submitted], sizeof(uint64_t))) {
+          ++submitted;
+        }
+      }
+      EXPECT_LE(session.get_in_flight(), PipelinedSession::get_capacity());
+
+      // reap at least one, and everything already completed
+      uint32_t to_reap = std::max<uint32_t>(1U, session.poll_completions());
+      for (uint32_t i = 0; i < to_reap; ++i) {
+        PipelinedResult result;
+        ASSERT_TRUE(session.reap(&result));
+        EXPECT_EQ(kErrorCodeOk, result.result_);
+        ASSERT_EQ(sizeof(uint64_t), result.output_len_);
+        EXPECT_EQ(inputs[reaped] + 1U, *reinterpret_cast<const uint64_t*>(result.output_));
+        ++reaped;
+      }
+    }
+    EXPECT_EQ(kTasks, submitted);
+    EXPECT_EQ(0, session.get_in_flight());
+
+    // errors are reported per task
+    EXPECT_TRUE(session.submit(failing_id, nullptr, 0));
+    EXPECT_TRUE(session.submit(increment_id, &inputs[0], sizeof(uint64_t)));
+    PipelinedResult result;
+    ASSERT_TRUE(session.reap(&result));
+    EXPECT_EQ(kErrorCodeInvalidParameter, result.result_);
+    ASSERT_TRUE(session.reap(&result));
+    EXPECT_EQ(kErrorCodeOk, result.result_);
+    EXPECT_FALSE(session.reap(&result));
+
+    session.release();
+    EXPECT_FALSE(session.is_valid());
+
+    // the thread is back in the pool and runs usual sessions
+    uint64_t input = 41;
+    ImpersonateSession usual;
+    EXPECT_TRUE(engine.get_thread_pool()->impersonate(
+      "increment_task",
+      &input,
+      sizeof(input),
+      &usual));
+    COERCE_ERROR(usual.get_result());
+    EXPECT_EQ(42U, *reinterpret_cast<const uint64_t*>(usual.get_raw_output_buffer()));
+    usual.release();
+    COERCE_ERROR(engine.uninitialize());
+  }
+  cleanup_test(options);
+}
+
+TEST(ThreadPoolTest, Pipelined) { run_pipelined(false); }
+TEST(ThreadPoolTest, PipelinedBatch) { run_pipelined(true); }
+
 TEST(ThreadPoolTest, CheckCbAddresses) {
   const ThreadGroupId kGroups = 2;
   const ThreadLocalOrdinal kCoresPerGroup = 8;
@@ -70,6 +70,64 @@ TEST(XctIdTest, SetThread) {
   EXPECT_EQ(456, id.get_ordinal());
 }
 
+TEST(XctIdTest, CompactLock) {
+  CompactLockableXctId id;
+  id.reset();
+  EXPECT_FALSE(id.is_keylocked());
+  EXPECT_TRUE(id.try_lock());
+  EXPECT_TRUE(id.is_keylocked());
+  EXPECT_FALSE(id.try_lock());
+  id.unlock();
+  EXPECT_FALSE(id.is_keylocked());
+  id.lock();
+  EXPECT_TRUE(id.is_keylocked());
+  id.unlock();
+  EXPECT_FALSE(id.is_keylocked());
+  EXPECT_FALSE(id.get_xct_id().is_valid());
+}
+
+TEST(XctIdTest, CompactUnlockWith) {
+  CompactLockableXctId id;
+  id.reset();
+  id.lock();
+  XctId new_id;
+  new_id.set(123, kMaxXctOrdinal);
+  id.unlock_with(new_id);
+  EXPECT_FALSE(id.is_keylocked());
+  EXPECT_EQ(new_id, id.get_xct_id());
+  EXPECT_EQ(123, id.get_xct_id().get_epoch_int());
+  EXPECT_EQ(kMaxXctOrdinal, id.get_xct_id().get_ordinal());
+
+  // the lock bit must not leak into the XctId part
+  id.lock();
+  EXPECT_EQ(new_id, id.get_xct_id());
+  EXPECT_EQ(kMaxXctOrdinal, id.get_xct_id().get_ordinal());
+  id.unlock();
+  EXPECT_EQ(new_id, id.spin_while_locked());
+}
+
+TEST(XctIdTest, CompactStatusBits) {
+  CompactLockableXctId id;
+  id.reset();
+  XctId new_id;
+  new_id.set(456, 789);
+  new_id.set_deleted();
+  id.lock();
+  id.unlock_with(new_id);
+  EXPECT_TRUE(id.is_deleted());
+  EXPECT_FALSE(id.is_moved());
+  EXPECT_FALSE(id.is_next_layer());
+  EXPECT_FALSE(id.is_being_written());
+  id.lock();
+  EXPECT_TRUE(id.is_deleted());
+  new_id.set_notdeleted();
+  new_id.set_moved();
+  id.unlock_with(new_id);
+  EXPECT_FALSE(id.is_deleted());
+  EXPECT_TRUE(id.is_moved());
+  EXPECT_TRUE(id.needs_track_moved());
+}
+
 }  // namespace xct
 }  // namespace foedus
 